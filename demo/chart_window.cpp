@@ -0,0 +1,45 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+#include <cmath>
+
+void chart_window()
+{
+	static int height = 12;
+	static int width = 60;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	// Keep the whole history, which is reduced to fit the window
+	auto opts = tuicpp::Chart::Option {
+		.capacity = 1 << 20,
+		.mode = tuicpp::Chart::Mode::min_max
+	};
+
+	auto win = tuicpp::Chart(
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		},
+		opts
+	);
+
+	// History, reduced in one pass
+	std::vector <float> history(1 << 20);
+	for (size_t i = 0; i < history.size(); i++)
+		history[i] = std::sin(i * 1e-5f) + 0.25f * std::sin(i * 0.37f);
+	win.push(history);
+
+	// Live samples
+	for (size_t i = history.size(); i < history.size() + 2000; i++) {
+		win.push(std::sin(i * 1e-5f) + 0.25f * std::sin(i * 0.37f));
+		napms(2);
+	}
+
+	win.getc();
+}
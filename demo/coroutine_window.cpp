@@ -0,0 +1,81 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+// Both tasks are live at once, shift-tab moves between them
+static tuicpp::Task <> pick_color(tuicpp::Scheduler &scheduler,
+		tuicpp::SelectionWindow &win, std::string &color)
+{
+	tuicpp::SelectionWindow::Selection selected;
+	if (co_await scheduler.select(win, selected))
+		color = "option " + std::to_string(*selected.begin());
+	else
+		color = "none";
+}
+
+static tuicpp::Task <> edit_name(tuicpp::Scheduler &scheduler,
+		tuicpp::FieldEditor &win, std::string &name)
+{
+	std::vector <tuicpp::Yielder> yielders {tuicpp::yielder(&name)};
+	if (!co_await scheduler.edit(win, yielders))
+		name = "(cancelled)";
+}
+
+void coroutine_window()
+{
+	static int height = 12;
+	static int width = 30;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = pr.second / 2 - width - 1;
+
+	std::string color;
+	std::string name = "Bob Joe";
+
+	{
+		auto selection = tuicpp::SelectionWindow(
+			"Color",
+			tuicpp::ScreenInfo {
+				.height = height,
+				.width = width,
+				.y = y,
+				.x = x
+			},
+			{"Red", "Green", "Blue"}
+		);
+
+		auto editor = tuicpp::FieldEditor(
+			"Name",
+			{"Name"},
+			tuicpp::ScreenInfo {
+				.height = height,
+				.width = width,
+				.y = y,
+				.x = x + width + 2
+			}
+		);
+
+		tuicpp::Scheduler scheduler;
+		scheduler.spawn(pick_color(scheduler, selection, color));
+		scheduler.spawn(edit_name(scheduler, editor, name));
+		scheduler.run();
+	}
+
+	mvprintw(y, x, "Color: %s", color.c_str());
+	mvprintw(y + 1, x, "Name: %.*s", width, name.c_str());
+	mvprintw(y + 2, x, "Press any key to quit...");
+	getch();
+}
+
+#else
+
+void coroutine_window()
+{
+	mvprintw(0, 0, "Coroutines need C++20, press any key to quit...");
+	getch();
+}
+
+#endif
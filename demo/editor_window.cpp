@@ -1,4 +1,5 @@
 #include "global.hpp"
+#include "../tuicpp.hpp"
 
 void editor_window()
 {
@@ -12,10 +13,25 @@ void editor_window()
 
 	std::string name = "Bob Joe";
 	std::string email;
+	std::string host;
+
+	// Built once, shared by every editor
+	static auto hosts = [] {
+		std::vector <std::string> words;
+		for (const char *role : {"api", "cache", "db", "web", "worker"}) {
+			for (int dc = 1; dc <= 4; dc++) {
+				for (int i = 0; i < 10000; i++)
+					words.push_back(std::string(role) + "-" + std::to_string(i)
+						+ ".dc" + std::to_string(dc) + ".example.com");
+			}
+		}
+
+		return tuicpp::Completions::make(std::move(words));
+	}();
 
 	auto win = new tuicpp::FieldEditor(
 		"Employee Editor",
-		{"Name", "Email"},
+		{"Name", "Email", "Host"},
 		tuicpp::ScreenInfo {
 			.height = height,
 			.width = width,
@@ -24,15 +40,25 @@ void editor_window()
 		}
 	);
 
+	// A slow check, given up on as soon as the email changes
+	win->set_validator(1, [](const std::string &value, const auto &cancelled) {
+		for (int i = 0; i < 10 && !cancelled(); i++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		return std::string(value.find('@') == std::string::npos ? "not an email" : "");
+	});
+
 	win->yield({
 		tuicpp::yielder(&name),
-		tuicpp::yielder(&email)
+		tuicpp::yielder(&email),
+		tuicpp::yielder(&host, hosts)
 	});
 
 	delete win;
 
-	mvprintw(y, x, "Name: %s", name.c_str());
-	mvprintw(y + 1, x, "Email: %s", email.c_str());
-	mvprintw(y + 2, x, "Press any key to quit...");
+	mvprintw(y, x, "Name: %.*s", width, name.c_str());
+	mvprintw(y + 1, x, "Email: %.*s", width, email.c_str());
+	mvprintw(y + 2, x, "Host: %.*s", width, host.c_str());
+	mvprintw(y + 3, x, "Press any key to quit...");
 	getch();
 }
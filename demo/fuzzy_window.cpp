@@ -0,0 +1,51 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+void fuzzy_window()
+{
+	static int height = 20;
+	static int width = 50;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	// A million file-like names to search through
+	static const char *words[] = {
+		"alpha", "beta", "gamma", "delta", "source",
+		"include", "window", "table", "render", "input"
+	};
+
+	tuicpp::FuzzyFinder::Candidates candidates;
+	for (int i = 0; i < 1000000; i++) {
+		candidates.push_back(
+			std::string(words[i % 10]) + "/"
+			+ words[(i / 10) % 10] + "/"
+			+ words[(i / 100) % 10] + "_"
+			+ std::to_string(i) + ".cpp"
+		);
+	}
+
+	auto win = new tuicpp::FuzzyFinder(
+		"Fuzzy Finder",
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		},
+		candidates
+	);
+
+	size_t index = 0;
+
+	bool yielded = win->yield(index);
+	delete win;
+
+	mvprintw(y, x, "Candidate selected? %s", yielded ? "yes" : "no");
+	if (yielded)
+		mvprintw(y + 1, x, "%.*s", width, candidates[index].c_str());
+
+	getch();
+}
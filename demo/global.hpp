@@ -1,10 +1,14 @@
 #ifndef GLOBAL_H_
 #define GLOBAL_H_
 
+#include <clocale>
 #include <iostream>
 #include <map>
+#include <string>
+#include <thread>
+#include <vector>
 
-#include "../tuicpp.hpp"
+#include "../tuicpp_fwd.hpp"
 
 void plain_window();
 void boxed_window();
@@ -12,6 +16,16 @@ void decorated_window();
 void selection_window();
 void multi_selection_window();
 void table_window();
+void numeric_table_window();
 void editor_window();
+void chart_window();
+void progress_window();
+void tree_window();
+void fuzzy_window();
+void coroutine_window();
+void stream_window();
+
+// Serve a selection window to each terminal
+void serve_sessions(const std::vector <std::string> &ttys);
 
 #endif
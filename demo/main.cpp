@@ -1,4 +1,5 @@
 #include "global.hpp"
+#include "../tuicpp.hpp"
 
 std::map <std::string, void (*)()> functions {
 	{"plain", plain_window},
@@ -7,11 +8,34 @@ std::map <std::string, void (*)()> functions {
 	{"selection", selection_window},
 	{"multi_selection", multi_selection_window},
 	{"table", table_window},
-	{"editor", editor_window}
+	{"numeric_table", numeric_table_window},
+	{"editor", editor_window},
+	{"chart", chart_window},
+	{"progress", progress_window},
+	{"tree", tree_window},
+	{"fuzzy", fuzzy_window},
+	{"coroutine", coroutine_window},
+	{"stream", stream_window}
 };
 
-int main()
+int main(int argc, char *argv[])
 {
+	// Optionally record or replay the session's input:
+	//	./demo record <file>
+	//	./demo replay <file>
+	//	./demo headless <file>	(replay without a terminal)
+	//
+	// or serve a window to other terminals, one session each:
+	//	./demo serve <tty>...
+	std::string mode = (argc > 2) ? argv[1] : "";
+	std::string path = (argc > 2) ? argv[2] : "";
+
+	if (mode == "serve") {
+		setlocale(LC_ALL, "");
+		serve_sessions(std::vector <std::string> (argv + 2, argv + argc));
+		return 0;
+	}
+
 	// Prompt user for window type
 	std::cout << "What type of window would you like to create?\n";
 	for (auto const &[key, value] : functions)
@@ -28,8 +52,50 @@ int main()
 		return 1;
 	}
 
-	// Run window type demo
+	// Run window type demo (the locale is needed for
+	//	wide characters)
+	setlocale(LC_ALL, "");
+
+	if (mode == "headless") {
+		tuicpp::Replayer replayer(path);
+		if (!replayer.good()) {
+			std::cout << "Could not read recording " << path << ".\n";
+			return 1;
+		}
+
+		double elapsed = 0;
+		{
+			tuicpp::HeadlessScreen screen;
+
+			auto start = std::chrono::steady_clock::now();
+			replayer.attach();
+			functions[input]();
+			replayer.detach();
+
+			std::chrono::duration <double, std::milli> ms =
+				std::chrono::steady_clock::now() - start;
+			elapsed = ms.count();
+		}
+
+		std::cout << "Replayed " << replayer.events().size()
+			<< " keys in " << elapsed << " ms\n";
+		return 0;
+	}
+
+	std::unique_ptr <tuicpp::Recorder> recorder;
+	std::unique_ptr <tuicpp::Replayer> replayer;
+
 	initscr();
+
+	if (mode == "record") {
+		recorder = std::make_unique <tuicpp::Recorder> (path);
+		recorder->attach();
+	} else if (mode == "replay") {
+		replayer = std::make_unique <tuicpp::Replayer>
+			(path, tuicpp::Replayer::Speed::real_time);
+		replayer->attach();
+	}
+
 	functions[input]();
 	endwin();
 
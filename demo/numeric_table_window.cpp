@@ -0,0 +1,56 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+#include <cmath>
+
+void numeric_table_window()
+{
+	static int height = 20;
+	static int width = 50;
+	static size_t rows = 1000000;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	auto columns = tuicpp::NumericTable <float> ::Columns {
+		{ .header = "x", .precision = 2 },
+		{ .header = "f(x)", .precision = 4 },
+		{ .header = "sin(x)", .precision = 6 }
+	};
+
+	for (size_t i = 0; i < rows; i++) {
+		float v = i * 0.01f;
+		columns[0].data.push_back(v);
+		columns[1].data.push_back(v * v);
+		columns[2].data.push_back(std::sin(v));
+	}
+
+	auto win = tuicpp::NumericTable <float> (
+		columns,
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		}
+	);
+
+	// Arrow keys and pages scroll, any other key quits
+	win.set_keypad(true);
+
+	int c;
+	while ((c = win.getc())) {
+		if (c == KEY_UP)
+			win.scroll_rows(-1);
+		else if (c == KEY_DOWN)
+			win.scroll_rows(1);
+		else if (c == KEY_PPAGE)
+			win.scroll_rows(-(height - 4));
+		else if (c == KEY_NPAGE)
+			win.scroll_rows(height - 4);
+		else
+			break;
+	}
+}
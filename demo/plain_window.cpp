@@ -1,4 +1,5 @@
 #include "global.hpp"
+#include "../tuicpp.hpp"
 
 void plain_window()
 {
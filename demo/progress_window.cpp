@@ -0,0 +1,48 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+void progress_window()
+{
+	static int height = 15;
+	static int width = 60;
+	static int tasks = 24;
+	static int workers = 4;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	auto win = tuicpp::ProgressBoard(
+		"Progress Board",
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		}
+	);
+
+	std::vector <tuicpp::ProgressBoard::Task *> list;
+	for (int i = 0; i < tasks; i++)
+		list.push_back(&win.add("Job #" + std::to_string(i), 100 + 25 * i));
+
+	// Workers share the jobs round robin
+	std::vector <std::thread> threads;
+	for (int w = 0; w < workers; w++) {
+		threads.emplace_back([&, w]() {
+			for (int i = w; i < tasks; i += workers) {
+				while (!list[i]->finished()) {
+					list[i]->advance();
+					std::this_thread::sleep_for(std::chrono::microseconds(500));
+				}
+			}
+		});
+	}
+
+	win.run();
+	for (auto &thread : threads)
+		thread.join();
+
+	win.getc();
+}
@@ -1,4 +1,5 @@
 #include "global.hpp"
+#include "../tuicpp.hpp"
 
 // TODO: clean up the duplicate code with a common function
 void selection_window()
@@ -0,0 +1,59 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+// One session per terminal, each on its own thread
+static void serve(const std::string &tty, int id)
+{
+	tuicpp::Screen screen(tty);
+	if (!screen.good())
+		return;
+
+	auto guard = screen.use();
+	cbreak();
+
+	static int height = 10;
+	static int width = 40;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	tuicpp::SelectionWindow::Selection selected;
+
+	{
+		// Blocking reads let the other sessions run
+		auto win = tuicpp::SelectionWindow(
+			"Session " + std::to_string(id),
+			tuicpp::ScreenInfo {
+				.height = height,
+				.width = width,
+				.y = y,
+				.x = x
+			},
+			{"Alpha", "Beta", "Gamma"}
+		);
+
+		win.yield(selected);
+	}
+
+	if (selected.empty())
+		mvprintw(y, x, "Nothing selected");
+	else
+		mvprintw(y, x, "Selected option %d", *selected.begin());
+
+	mvprintw(y + 1, x, "Press any key to quit...");
+	refresh();
+
+	screen.wait();
+}
+
+void serve_sessions(const std::vector <std::string> &ttys)
+{
+	std::vector <std::thread> threads;
+	for (size_t i = 0; i < ttys.size(); i++)
+		threads.emplace_back(serve, ttys[i], i + 1);
+
+	for (auto &thread : threads)
+		thread.join();
+}
@@ -0,0 +1,95 @@
+#include "global.hpp"
+#include "../tuicpp_inl.hpp"
+
+#include <unistd.h>
+
+void stream_window()
+{
+	static int height = 20;
+	static int width = 60;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	using Record = tuicpp::DelimitedReader::Record;
+
+	auto from = tuicpp::Table <Record> ::From(
+		{"Time", "Host", "Status", "Latency (ms)"},
+		[](const Record &record, size_t column) {
+			return column < record.size() ? record[column] : "";
+		}
+	);
+
+	auto win = tuicpp::Table <Record> (
+		from,
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		}
+	);
+
+	win.set_keypad(true);
+
+	// A producer feeding CSV into a pipe, like `tail -f` would
+	int fds[2];
+	if (pipe(fds) < 0)
+		return;
+
+	std::atomic <bool> stop {false};
+	std::thread producer([&stop, fd = fds[1]]() {
+		const char *statuses[] = {"ok", "ok", "ok", "\"slow, retrying\"", "down"};
+
+		std::string lines;
+		for (int i = 0; i < 2000 && !stop; i++) {
+			lines += std::to_string(i) + ",host-" + std::to_string(i * 7 % 97)
+				+ ".example.com," + statuses[i % 5]
+				+ "," + std::to_string(i * 37 % 500) + "\n";
+
+			// Bursts of a few rows at a time
+			if (i % 4 == 3) {
+				if (write(fd, lines.data(), lines.size()) < 0)
+					break;
+
+				lines.clear();
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+		}
+
+		close(fd);
+	});
+
+	tuicpp::DelimitedReader reader(fds[0]);
+
+	auto parse = [](const Record &record) {
+		return record;
+	};
+
+	// Digits sort by a column and arrows scroll while rows come
+	// 	in, q quits
+	while (true) {
+		bool open = win.ingest(reader, parse);
+
+		int c = win.try_getc();
+		if (c == ERR) {
+			if (open)
+				reader.wait(16);
+			else
+				std::this_thread::sleep_for(std::chrono::milliseconds(16));
+
+			continue;
+		}
+
+		if (c == 'q')
+			break;
+
+		win.sort_key(c) || win.scroll_key(c);
+	}
+
+	stop = true;
+	producer.join();
+	close(fds[0]);
+}
@@ -1,4 +1,5 @@
 #include "global.hpp"
+#include "../tuicpp.hpp"
 
 void table_window()
 {
@@ -10,19 +11,23 @@ void table_window()
 	int y = (pr.first - height) / 2;
 	int x = (pr.second - width) / 2;
 
+	// Powers of x, more than fit in the window
 	auto to_str = [](const float &i, size_t column) {
-		if (column == 0)
-			return std::to_string(i);
-		else
-			return std::to_string(i * i);
-	};
+		float v = 1;
+		for (size_t k = 0; k <= column; k++)
+			v *= i;
 
-	auto from = tuicpp::Table <float> ::From({"x", "f(x)"}, to_str);
-	from.data = {
-		0, 0.5, 1.0, 1.5, 2.0, 2.5,
-		3.0, 3.5, 4.0, 4.5, 5.0
+		return std::to_string(v);
 	};
 
+	auto from = tuicpp::Table <float> ::From(
+		{"x", "x^2", "x^3", "x^4", "x^5", "x^6", "x^7", "x^8"},
+		to_str
+	);
+
+	for (int i = 0; i <= 40; i++)
+		from.data.push_back(i * 0.5f);
+
 	auto win = tuicpp::Table <float> (
 		from,
 		tuicpp::ScreenInfo {
@@ -33,5 +38,27 @@ void table_window()
 		}
 	);
 
-	win.getc();
+	// Bold headers, dimmed stripes and large squares in red
+	if (has_colors()) {
+		start_color();
+		init_pair(1, COLOR_RED, COLOR_BLACK);
+	}
+
+	auto style = tuicpp::Table <float> ::Style {};
+	style.header = A_BOLD;
+	style.stripe = A_DIM;
+	style.rules.push_back({
+		1, [](const float &v) { return v * v > 100; },
+		COLOR_PAIR(1) | A_BOLD
+	});
+
+	win.set_style(style);
+
+	// Keep x in view while scrolling sideways
+	win.freeze_columns(1);
+	win.set_keypad(true);
+
+	// Digits sort by a column, arrows scroll, any other key quits
+	int c;
+	while (win.sort_key(c = win.getc()) || win.scroll_key(c));
 }
@@ -0,0 +1,55 @@
+#include "global.hpp"
+#include "../tuicpp.hpp"
+
+void tree_window()
+{
+	static int height = 20;
+	static int width = 50;
+
+	auto pr = tuicpp::Window::limits();
+
+	int y = (pr.first - height) / 2;
+	int x = (pr.second - width) / 2;
+
+	// A thousand children per node, four levels deep
+	auto fetch = [](const tuicpp::TreeView::Path &path) {
+		tuicpp::TreeView::Entries entries;
+		for (int i = 0; i < 1000; i++) {
+			entries.push_back({
+				"node-" + std::to_string(path.size()) + "." + std::to_string(i),
+				path.size() >= 3
+			});
+		}
+
+		return entries;
+	};
+
+	auto opts = tuicpp::TreeView::Option {
+		.max_nodes = 100000
+	};
+
+	auto win = new tuicpp::TreeView(
+		"Tree View",
+		tuicpp::ScreenInfo {
+			.height = height,
+			.width = width,
+			.y = y,
+			.x = x
+		},
+		fetch,
+		opts
+	);
+
+	auto path = tuicpp::TreeView::Path {};
+
+	bool yielded = win->yield(path);
+	delete win;
+
+	std::string str;
+	for (const auto &label : path)
+		str += "/" + label;
+
+	mvprintw(y, x, "Node selected? %s", yielded ? "yes" : "no");
+	mvprintw(y + 1, x, "%.*s", width, str.c_str());
+	getch();
+}
@@ -0,0 +1,125 @@
+// Widgets which repaint on a timer present their frames through an
+// 	attached Renderer, without waiting for a key to be read
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "../tuicpp.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		std::printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+// Wait for a frame on the pipe and drain it, false on timeout
+static bool frame(int fd, int timeout = 1000)
+{
+	pollfd pfd {fd, POLLIN, 0};
+	if (poll(&pfd, 1, timeout) <= 0)
+		return false;
+
+	char buffer[4096];
+	while (poll(&pfd, 1, 0) > 0 && read(fd, buffer, sizeof(buffer)) > 0);
+	return true;
+}
+
+// Frames of a progress board, while it runs
+static void progress_frames(int fd)
+{
+	auto board = tuicpp::ProgressBoard("Jobs",
+		tuicpp::ScreenInfo {.height = 8, .width = 40, .y = 0, .x = 0}
+	);
+
+	auto &task = board.add("Job", 4);
+
+	// The first sample is presented as well
+	std::atomic <int> frames {0};
+	std::thread worker([&]() {
+		for (int i = 0; i < 4; i++) {
+			frames += frame(fd);
+			task.advance();
+		}
+
+		frames += frame(fd);
+	});
+
+	board.run(std::chrono::milliseconds(5));
+	worker.join();
+
+	check(frames == 5, "progress board frames");
+}
+
+// Frames of a table, while it reads a stream
+static void ingest_frames(int fd)
+{
+	auto from = tuicpp::Table <std::string> ::From(
+		{"Line"},
+		[](const std::string &line, size_t) {
+			return line;
+		}
+	);
+
+	auto table = tuicpp::Table <std::string> (from,
+		tuicpp::ScreenInfo {.height = 10, .width = 20, .y = 0, .x = 0}
+	);
+
+	// Anything staged before reading is not counted
+	while (frame(fd, 0));
+
+	int lines[2];
+	check(pipe(lines) == 0, "stream pipe");
+
+	std::atomic <int> frames {0};
+	std::thread writer([&]() {
+		for (const char *line : {"a\n", "b\n"}) {
+			check(write(lines[1], line, 2) == 2, "write line");
+			frames += frame(fd);
+		}
+
+		close(lines[1]);
+	});
+
+	tuicpp::DelimitedReader reader(lines[0]);
+	table.ingest_all(reader, [](const tuicpp::DelimitedReader::Record &record) {
+		return record[0];
+	}, std::chrono::milliseconds(5));
+
+	writer.join();
+	close(lines[0]);
+
+	check(frames == 2, "ingest frames");
+}
+
+int main()
+{
+	tuicpp::HeadlessScreen screen;
+	check(screen.good(), "headless screen");
+
+	int fds[2];
+	check(pipe(fds) == 0, "pipe");
+
+	tuicpp::Renderer renderer(fds[1]);
+	renderer.attach();
+
+	progress_frames(fds[0]);
+	ingest_frames(fds[0]);
+
+	renderer.detach();
+	close(fds[0]);
+	close(fds[1]);
+
+	if (failures)
+		return 1;
+
+	std::printf("ok\n");
+	return 0;
+}
@@ -0,0 +1,113 @@
+// Exceptions thrown by spawned tasks come out of the Scheduler
+#include <cstdio>
+#include <stdexcept>
+
+#include "../tuicpp.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+static const char *recording = "scheduler_exceptions.tuir";
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		std::printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static tuicpp::Task <> fail_now()
+{
+	throw std::runtime_error("now");
+	co_return;
+}
+
+static tuicpp::Task <int> fail_inner()
+{
+	throw std::runtime_error("inner");
+	co_return 0;
+}
+
+// Throws once its window is finished, through an awaited task
+static tuicpp::Task <> fail_later(tuicpp::Scheduler &scheduler, tuicpp::SelectionWindow &win)
+{
+	tuicpp::SelectionWindow::Selection selected;
+	co_await scheduler.select(win, selected);
+	co_await fail_inner();
+}
+
+int main()
+{
+	tuicpp::HeadlessScreen screen;
+	check(screen.good(), "headless screen");
+
+	// Thrown before awaiting anything
+	{
+		tuicpp::Scheduler scheduler;
+
+		bool thrown = false;
+		try {
+			scheduler.spawn(fail_now());
+		} catch (const std::runtime_error &e) {
+			thrown = std::string(e.what()) == "now";
+		}
+
+		check(thrown, "exception from spawn");
+		check(scheduler.pending() == 0, "nothing pending");
+	}
+
+	// Thrown after a window is finished
+	{
+		{
+			tuicpp::Recorder recorder(recording);
+			recorder.attach();
+			recorder.record(10, true);
+			recorder.detach();
+		}
+
+		tuicpp::Replayer replayer(recording);
+		replayer.attach();
+
+		tuicpp::SelectionWindow win("Pick",
+			tuicpp::ScreenInfo {.height = 10, .width = 30, .y = 0, .x = 0},
+			{"One", "Two"}
+		);
+
+		tuicpp::Scheduler scheduler;
+		scheduler.spawn(fail_later(scheduler, win));
+
+		bool thrown = false;
+		try {
+			scheduler.run();
+		} catch (const std::runtime_error &e) {
+			thrown = std::string(e.what()) == "inner";
+		}
+
+		check(thrown, "exception from run");
+
+		// Nothing is left to rethrow
+		scheduler.run();
+
+		replayer.detach();
+	}
+
+	std::remove(recording);
+
+	if (failures)
+		return 1;
+
+	std::printf("ok\n");
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::printf("Coroutines need C++20\n");
+	return 1;
+}
+
+#endif
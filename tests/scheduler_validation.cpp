@@ -0,0 +1,108 @@
+// Drives a FieldEditor with a validator through the coroutine
+// 	Scheduler, headlessly from a recording
+#include <cstdio>
+
+#include "../tuicpp.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+static const char *recording = "scheduler_validation.tuir";
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		std::printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+// Record keys, each read by a blocking read
+static void record(const std::vector <int> &keys)
+{
+	tuicpp::Recorder recorder(recording);
+	recorder.attach();
+	for (int key : keys)
+		recorder.record(key, true);
+	recorder.detach();
+}
+
+static tuicpp::Task <> edit(tuicpp::Scheduler &scheduler, tuicpp::FieldEditor &win,
+		std::string &email, bool &confirmed)
+{
+	std::vector <tuicpp::Yielder> yielders {tuicpp::yielder(&email)};
+	confirmed = co_await scheduler.edit(win, yielders);
+}
+
+// Edit a single email field with the recorded keys, true if confirmed
+static bool run(tuicpp::FieldEditor &win, std::string &email)
+{
+	tuicpp::Replayer replayer(recording);
+	replayer.attach();
+
+	win.set_validator(0, [](const std::string &value) {
+		return std::string(value.find('@') == std::string::npos ? "not an email" : "");
+	}, std::chrono::milliseconds(0));
+
+	bool confirmed = false;
+
+	tuicpp::Scheduler scheduler;
+	scheduler.spawn(edit(scheduler, win, email, confirmed));
+	scheduler.run();
+
+	replayer.detach();
+	return confirmed;
+}
+
+int main()
+{
+	tuicpp::HeadlessScreen screen;
+	check(screen.good(), "headless screen");
+
+	tuicpp::ScreenInfo info {.height = 10, .width = 40, .y = 0, .x = 0};
+
+	// Confirming an invalid field does nothing, and the message is
+	// 	shown without any more keys (the end of the recording
+	// 	cancels the editor)
+	{
+		record({'a', KEY_DOWN, 10});
+
+		std::string email;
+		tuicpp::FieldEditor win("Editor", {"Email"}, info);
+
+		check(!run(win, email), "invalid field confirmed");
+		check(email == "a", "keys fed to the field");
+		check(win.message(0) == "not an email", "message collected");
+	}
+
+	// Fixing the field clears the message and confirms
+	{
+		record({'a', KEY_DOWN, 10, KEY_UP, '@', KEY_DOWN, 10});
+
+		std::string email;
+		tuicpp::FieldEditor win("Editor", {"Email"}, info);
+
+		check(run(win, email), "valid field not confirmed");
+		check(email == "a@", "keys fed to the field");
+		check(win.message(0).empty(), "message cleared");
+	}
+
+	std::remove(recording);
+
+	if (failures)
+		return 1;
+
+	std::printf("ok\n");
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::printf("Coroutines need C++20\n");
+	return 1;
+}
+
+#endif
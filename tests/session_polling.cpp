@@ -0,0 +1,81 @@
+// A session polling in the background does not hold up the others
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../tuicpp.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		std::printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static std::atomic <tuicpp::ProgressBoard::Task *> task {nullptr};
+static std::atomic <bool> finished {false};
+static std::atomic <bool> advanced {false};
+
+// Session which samples a board until its task is done
+static void board_session()
+{
+	tuicpp::HeadlessScreen screen;
+
+	auto board = tuicpp::ProgressBoard("Jobs",
+		tuicpp::ScreenInfo {.height = 5, .width = 40, .y = 0, .x = 0}
+	);
+
+	task = &board.add("Job", 1);
+	board.run(std::chrono::milliseconds(10));
+	finished = true;
+
+	// The task goes away with the board
+	while (!advanced)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main()
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	check(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0, "pty");
+
+	std::thread board(board_session);
+	while (!task)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	// Finishes the board eventually, so that a failure does not hang
+	std::thread watchdog([]() {
+		std::this_thread::sleep_for(std::chrono::seconds(2));
+		task.load()->advance();
+		advanced = true;
+	});
+
+	{
+		tuicpp::Screen screen(ptsname(master), "xterm");
+		check(screen.good(), "pty session");
+
+		auto guard = screen.use();
+		tuicpp::PlainWindow win(tuicpp::ScreenInfo {.height = 5, .width = 20, .y = 0, .x = 0});
+
+		check(write(master, "x", 1) == 1, "write key");
+		check(win.getc() == 'x', "key read");
+		check(!finished, "key read while the board is running");
+	}
+
+	watchdog.join();
+	board.join();
+	close(master);
+
+	if (failures)
+		return 1;
+
+	std::printf("ok\n");
+	return 0;
+}
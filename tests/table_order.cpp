@@ -0,0 +1,151 @@
+// Rows shown by a table follow its sort and filter through edits
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "../tuicpp.hpp"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		std::printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static std::string cell(int value, size_t column)
+{
+	return std::to_string(column == 0 ? value : value % 7);
+}
+
+// Rows shown, worked out from scratch
+struct Model {
+	std::vector <int> data;
+	int column = -1;
+	bool ascending = true;
+	bool odd = false;
+	std::string query;
+
+	std::vector <size_t> shown() const {
+		std::vector <size_t> rows;
+		for (size_t n = 0; n < data.size(); n++) {
+			if (odd && data[n] % 2 == 0)
+				continue;
+
+			if (!query.empty()
+					&& cell(data[n], 0).find(query) == std::string::npos
+					&& cell(data[n], 1).find(query) == std::string::npos)
+				continue;
+
+			rows.push_back(n);
+		}
+
+		if (column >= 0) {
+			std::stable_sort(rows.begin(), rows.end(), [&](size_t a, size_t b) {
+				int ka = std::stoi(cell(data[a], column));
+				int kb = std::stoi(cell(data[b], column));
+				return ascending ? ka < kb : kb < ka;
+			});
+		}
+
+		return rows;
+	}
+};
+
+static void compare(const tuicpp::Table <int> &table, const Model &model, const char *what)
+{
+	auto rows = model.shown();
+
+	bool same = table.visible() == rows.size()
+		&& table.data_index(rows.size()) == -1;
+	for (size_t n = 0; same && n < rows.size(); n++)
+		same = table.data_index(n) == (long) rows[n];
+
+	check(same, what);
+}
+
+int main()
+{
+	tuicpp::HeadlessScreen screen;
+
+	Model model;
+	for (int n = 0; n < 40; n++)
+		model.data.push_back((n * 37) % 101);
+
+	auto from = tuicpp::Table <int> ::From({"Value", "Mod"}, cell);
+	from.data = model.data;
+
+	auto table = tuicpp::Table <int> (from,
+		tuicpp::ScreenInfo {.height = 10, .width = 30, .y = 0, .x = 0}
+	);
+	compare(table, model, "initial order");
+
+	table.filter([](const int &value) {
+		return value % 2 != 0;
+	});
+	model.odd = true;
+	compare(table, model, "filtered");
+
+	table.sort_by(1, true);
+	model.column = 1;
+	compare(table, model, "filtered and sorted");
+
+	table.search("1");
+	model.query = "1";
+	compare(table, model, "searched");
+
+	table.search("11");
+	model.query = "11";
+	compare(table, model, "narrower search");
+
+	table.search("1");
+	model.query = "1";
+	compare(table, model, "wider search");
+
+	// Rows moving, entering and leaving the filter
+	for (int n = 0; n < 40; n += 3) {
+		table.set_row(n, n + 1);
+		model.data[n] = n + 1;
+	}
+	compare(table, model, "rows set");
+
+	for (int n = 0; n < 20; n++) {
+		table.append(n * 5);
+		model.data.push_back(n * 5);
+	}
+	compare(table, model, "rows appended");
+
+	table.sort_by(1, false);
+	model.ascending = false;
+	compare(table, model, "sorted descending");
+
+	table.unsort();
+	model.column = -1;
+	compare(table, model, "unsorted");
+
+	table.set_row(1, 111);
+	model.data[1] = 111;
+	table.append(1);
+	model.data.push_back(1);
+	compare(table, model, "unsorted edits");
+
+	table.clear_filter();
+	model.odd = false;
+	model.query.clear();
+	compare(table, model, "filter cleared");
+
+	table.sort_by(0, true);
+	model.column = 0;
+	model.ascending = true;
+	table.set_row(2, 0);
+	model.data[2] = 0;
+	compare(table, model, "sorted without a filter");
+
+	if (failures)
+		return 1;
+
+	std::printf("ok\n");
+	return 0;
+}
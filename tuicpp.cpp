@@ -0,0 +1,2985 @@
+#include <cerrno>
+#include <condition_variable>
+#include <cwchar>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#include <fcntl.h>
+#include <poll.h>
+
+#include "tuicpp.hpp"
+#include "tuicpp_inl.hpp"
+
+namespace tuicpp {
+
+// Display widths
+int char_width(char32_t cp)
+{
+	// ASCII is always a single column
+	if (cp < 0x80)
+		return 1;
+
+	// Entries hold the width plus one, zero is not known yet
+	static constexpr char32_t cached = 0x20000;
+	static std::atomic <signed char> cache[cached];
+
+	if (cp < cached) {
+		signed char w = cache[cp].load(std::memory_order_relaxed);
+		if (w != 0)
+			return w - 1;
+	}
+
+	// Unprintable characters still take up a column
+	int w = ::wcwidth((wchar_t) cp);
+	if (w < 0)
+		w = 1;
+
+	if (cp < cached)
+		cache[cp].store(w + 1, std::memory_order_relaxed);
+
+	return w;
+}
+
+char32_t decode_utf8(const std::string &str, size_t &i)
+{
+	unsigned char c = str[i++];
+	if (c < 0x80)
+		return c;
+
+	int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+	if (extra < 0)
+		return 0xFFFD;
+
+	char32_t cp = c & (0x3F >> extra);
+	for (int k = 0; k < extra; k++) {
+		if (i >= str.size() || (str[i] & 0xC0) != 0x80)
+			return 0xFFFD;
+
+		cp = (cp << 6) | (str[i++] & 0x3F);
+	}
+
+	return cp;
+}
+
+size_t display_width(const std::string &str)
+{
+	const char *data = str.data();
+	size_t n = str.size();
+
+	size_t width = 0;
+	size_t i = 0;
+	while (i < n) {
+		// Skip through ASCII eight bytes at a time
+		while (i + 8 <= n) {
+			uint64_t word;
+			std::memcpy(&word, data + i, 8);
+			if (word & 0x8080808080808080ull)
+				break;
+
+			i += 8;
+			width += 8;
+		}
+
+		if (i >= n)
+			break;
+
+		if ((unsigned char) data[i] < 0x80) {
+			i++;
+			width++;
+			continue;
+		}
+
+		width += char_width(decode_utf8(str, i));
+	}
+
+	return width;
+}
+
+size_t fit_width(const std::string &str, size_t width)
+{
+	size_t used = 0;
+	size_t i = 0;
+	while (i < str.size()) {
+		size_t j = i;
+		size_t w = char_width(decode_utf8(str, j));
+		if (used + w > width)
+			break;
+
+		used += w;
+		i = j;
+	}
+
+	return i;
+}
+
+size_t tail_width(const std::string &str, size_t width)
+{
+	size_t total = display_width(str);
+
+	size_t i = 0;
+	while (i < str.size() && total > width)
+		total -= char_width(decode_utf8(str, i));
+
+	return i;
+}
+
+std::string pad_width(const std::string &str, size_t width)
+{
+	std::string out = str.substr(0, fit_width(str, width));
+	out.append(width - display_width(out), ' ');
+	return out;
+}
+
+// Screen
+
+// Curses state is global, so sessions take turns
+static std::mutex screen_lock;
+
+// Open sessions, and the ones closed while others were still open:
+// 	delscreen frees the windows of every session (curses keeps a
+// 	single list of them), so it waits for the last one to close
+struct ClosedScreen {
+	SCREEN		*screen;
+	std::FILE	*in;
+	std::FILE	*out;
+};
+
+static size_t open_screens = 0;
+static std::vector <ClosedScreen> closed_screens;
+
+void Screen::_open(int in_fd, int out_fd, const char *term) {
+	if (in_fd < 0 || out_fd < 0)
+		return;
+
+	_in = fdopen(in_fd, "r");
+	_out = fdopen(out_fd, "w");
+	if (!_in || !_out)
+		return;
+
+	// Creating a session switches to it, so hold the lock and
+	// 	switch back to the session in use (if any) afterwards
+	std::unique_lock <std::mutex> lock(screen_lock, std::defer_lock);
+	if (!_current)
+		lock.lock();
+
+	_screen = newterm(term, _out, _in);
+	if (_screen) {
+		open_screens++;
+		_probe = newpad(1, 1);
+		keypad(_probe, true);
+		nodelay(_probe, true);
+	}
+
+	if (_current && _current->_screen)
+		set_term(_current->_screen);
+}
+
+Screen::Guard::Guard(Screen *screen)
+		: _screen(screen), _previous(_current) {
+	if (!screen || screen == _previous)
+		return;
+
+	// Only the outermost guard on a thread takes the lock
+	if (!_previous) {
+		screen_lock.lock();
+		_locked = true;
+	}
+
+	_current = screen;
+	if (screen->_screen)
+		set_term(screen->_screen);
+}
+
+Screen::Guard::~Guard() {
+	if (!_screen || _screen == _previous)
+		return;
+
+	_current = _previous;
+	if (_previous && _previous->_screen)
+		set_term(_previous->_screen);
+
+	if (_locked)
+		screen_lock.unlock();
+}
+
+Screen::Screen(int in_fd, int out_fd, const char *term) {
+	_open(dup(in_fd), dup(out_fd), term);
+}
+
+Screen::Screen(const std::string &tty, const char *term) {
+	int fd = open(tty.c_str(), O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		return;
+
+	_open(fd, dup(fd), term);
+}
+
+Screen::~Screen() {
+	if (_screen) {
+		Guard guard(this);
+		WindowPool::clear(this);
+		if (_probe)
+			delwin(_probe);
+
+		endwin();
+
+		if (--open_screens > 0) {
+			closed_screens.push_back(ClosedScreen {_screen, _in, _out});
+			_in = _out = nullptr;
+		} else {
+			delscreen(_screen);
+			for (const auto &closed : closed_screens) {
+				delscreen(closed.screen);
+				std::fclose(closed.out);
+				std::fclose(closed.in);
+			}
+
+			closed_screens.clear();
+		}
+	}
+
+	if (_out)
+		std::fclose(_out);
+	if (_in)
+		std::fclose(_in);
+}
+
+bool Screen::wait(int timeout) {
+	if (!_in)
+		return false;
+
+	// Keys left over from an earlier read (e.g. after an escape
+	// 	sequence) are not on the descriptor anymore
+	if (_probe) {
+		int c = wgetch(_probe);
+		if (c != ERR) {
+			ungetch(c);
+			return true;
+		}
+	}
+
+	// Let other sessions run while waiting
+	Unlock unlock;
+
+	pollfd pfd {fileno(_in), POLLIN, 0};
+	int n;
+	do {
+		n = poll(&pfd, 1, timeout);
+	} while (n < 0 && errno == EINTR);
+
+	return n > 0 && (pfd.revents & POLLIN);
+}
+
+void Screen::sleep(int ms) {
+	Unlock unlock;
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+Screen::Unlock::Unlock() : _screen(_current) {
+	if (_screen)
+		screen_lock.unlock();
+}
+
+Screen::Unlock::~Unlock() {
+	if (!_screen)
+		return;
+
+	// Other sessions may have switched curses over meanwhile
+	screen_lock.lock();
+	if (_screen->_screen)
+		set_term(_screen->_screen);
+}
+
+// Renderer
+Renderer *&Renderer::_slot() {
+	if (Screen *screen = Screen::current())
+		return screen->_renderer;
+
+	return _current;
+}
+
+void Renderer::_fit() {
+	int height, width;
+	getmaxyx(newscr, height, width);
+	if (height == _height && width == _width)
+		return;
+
+	_height = height;
+	_width = width;
+
+	// One extra cell for the terminator when reading rows
+	_back.assign(_height * _width, Cell {' ', A_NORMAL});
+	_row.resize(_width + 1);
+	invalidate();
+}
+
+void Renderer::_read_row(int y) {
+	Cell *row = &_back[y * _width];
+
+#if NCURSES_WIDECHAR
+	// Right halves of wide characters are skipped when reading
+	mvwin_wchnstr(newscr, y, 0, _row.data(), _width);
+
+	int x = 0;
+	for (int i = 0; x < _width; i++) {
+		wchar_t wch[CCHARW_MAX + 1] = {0};
+		attr_t attr = A_NORMAL;
+		short pair = 0;
+
+		getcchar(&_row[i], wch, &attr, &pair, nullptr);
+
+		// Terminated early, the rest is blank
+		if (wch[0] == 0) {
+			for (; x < _width; x++)
+				row[x] = Cell {' ', A_NORMAL};
+			break;
+		}
+
+		attr = (attr & ~A_COLOR) | COLOR_PAIR(pair);
+		row[x++] = Cell {(char32_t) wch[0], attr};
+
+		for (int w = char_width(wch[0]); w > 1 && x < _width; w--)
+			row[x++] = Cell {0, attr};
+	}
+#else
+	mvwinchnstr(newscr, y, 0, _row.data(), _width);
+	for (int x = 0; x < _width; x++)
+		row[x] = Cell {_row[x] & A_CHARTEXT, _row[x] & A_ATTRIBUTES};
+#endif
+}
+
+void Renderer::_move(int y, int x) {
+	if (y == _cy && x == _cx)
+		return;
+
+	_buffer += "\x1b[" + std::to_string(y + 1)
+		+ ";" + std::to_string(x + 1) + "H";
+
+	_cy = y;
+	_cx = x;
+}
+
+void Renderer::_set_attr(attr_t attr) {
+	if (attr == _attr)
+		return;
+
+	// Alternate character set is separate from SGR (and
+	// 	unknown after invalidating)
+	if (_attr == (attr_t) -1 || ((attr ^ _attr) & A_ALTCHARSET))
+		_buffer += (attr & A_ALTCHARSET) ? "\x1b(0" : "\x1b(B";
+
+	_buffer += "\x1b[0";
+	if (attr & A_BOLD)
+		_buffer += ";1";
+	if (attr & A_DIM)
+		_buffer += ";2";
+	if (attr & A_UNDERLINE)
+		_buffer += ";4";
+	if (attr & A_BLINK)
+		_buffer += ";5";
+	if (attr & (A_REVERSE | A_STANDOUT))
+		_buffer += ";7";
+	if (attr & A_INVIS)
+		_buffer += ";8";
+
+	short pair = PAIR_NUMBER(attr);
+	short fg = -1, bg = -1;
+	if (pair > 0)
+		pair_content(pair, &fg, &bg);
+
+	if (fg >= 0)
+		_buffer += ";38;5;" + std::to_string(fg);
+	if (bg >= 0)
+		_buffer += ";48;5;" + std::to_string(bg);
+
+	_buffer += 'm';
+	_attr = attr;
+}
+
+void Renderer::_encode(char32_t cp) {
+	if (cp < 0x80) {
+		_buffer += (char) cp;
+	} else if (cp < 0x800) {
+		_buffer += (char) (0xC0 | (cp >> 6));
+		_buffer += (char) (0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		_buffer += (char) (0xE0 | (cp >> 12));
+		_buffer += (char) (0x80 | ((cp >> 6) & 0x3F));
+		_buffer += (char) (0x80 | (cp & 0x3F));
+	} else {
+		_buffer += (char) (0xF0 | (cp >> 18));
+		_buffer += (char) (0x80 | ((cp >> 12) & 0x3F));
+		_buffer += (char) (0x80 | ((cp >> 6) & 0x3F));
+		_buffer += (char) (0x80 | (cp & 0x3F));
+	}
+}
+
+void Renderer::_put(const Cell &c) {
+	_set_attr(c.attr);
+	_encode(c.ch);
+
+	// The cursor is in limbo after the last column
+	_cx += char_width(c.ch);
+	if (_cx >= _width)
+		_cx = _cy = -1;
+}
+
+void Renderer::_diff_row(int y) {
+	const Cell *front = &_front[y * _width];
+	const Cell *back = &_back[y * _width];
+
+	for (int x = 0; x < _width; x++) {
+		// Right halves go out with their left half
+		if (front[x] == back[x] || back[x].ch == 0)
+			continue;
+
+		// Short unchanged gaps with the current attributes are
+		// 	cheaper to rewrite than to jump over
+		if (y == _cy && x > _cx && x - _cx <= 4) {
+			bool same = true;
+			for (int i = _cx; i < x; i++)
+				same &= (back[i].attr == _attr);
+
+			if (same) {
+				for (int i = _cx; i < x; i++) {
+					if (back[i].ch != 0)
+						_put(back[i]);
+				}
+			}
+		}
+
+		_move(y, x);
+		_put(back[x]);
+	}
+}
+
+void Renderer::_flush() {
+	const char *data = _buffer.data();
+	size_t left = _buffer.size();
+	while (left > 0) {
+		ssize_t n = ::write(_fd, data, left);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		data += n;
+		left -= n;
+	}
+
+	_buffer.clear();
+}
+
+Renderer::~Renderer() {
+	if (_slot() == this)
+		detach();
+}
+
+void Renderer::attach() {
+	Renderer *&current = _slot();
+	if (current && current != this)
+		current->detach();
+
+	// Flush anything curses has pending (e.g. from initscr)
+	doupdate();
+
+	current = this;
+	_height = _width = 0;
+	_fit();
+}
+
+void Renderer::detach() {
+	Renderer *&current = _slot();
+	if (current != this)
+		return;
+
+	_set_attr(A_NORMAL);
+	_flush();
+
+	// Curses has not seen any of our frames
+	clearok(curscr, true);
+	current = nullptr;
+}
+
+void Renderer::invalidate() {
+	_front.assign(_height * _width, Cell {(char32_t) -1, (attr_t) -1});
+	_attr = (attr_t) -1;
+	_cy = _cx = -1;
+	_dirty = true;
+}
+
+void Renderer::present() {
+	_fit();
+
+	// Reading back cells moves the cursor of the virtual screen
+	int cy, cx;
+	getyx(newscr, cy, cx);
+
+	for (int y = 0; y < _height; y++)
+		_read_row(y);
+
+	for (int y = 0; y < _height; y++)
+		_diff_row(y);
+
+	wmove(newscr, cy, cx);
+	if (!is_leaveok(newscr))
+		_move(cy, cx);
+
+	// The back grid is fully rewritten on the next frame
+	std::swap(_front, _back);
+
+	_flush();
+	_dirty = false;
+}
+
+// Input and output helpers
+void refresh_window(WINDOW *win)
+{
+	if (Renderer *renderer = Renderer::current()) {
+		wnoutrefresh(win);
+		renderer->mark();
+	} else {
+		wrefresh(win);
+	}
+}
+
+void stage_window(WINDOW *win)
+{
+	wnoutrefresh(win);
+	if (Renderer *renderer = Renderer::current())
+		renderer->mark();
+}
+
+void present_frame()
+{
+	Renderer *renderer = Renderer::current();
+	if (renderer && renderer->dirty())
+		renderer->present();
+}
+
+void terminal_write(const std::string &seq)
+{
+	// To the terminal of the session in use, if any
+	Screen *screen = Screen::current();
+	int fd = screen ? screen->output_fd() : STDOUT_FILENO;
+	if (fd < 0)
+		return;
+
+	// Anything curses has pending goes first
+	if (screen)
+		screen->flush();
+	else
+		fflush(stdout);
+
+	const char *data = seq.data();
+	size_t left = seq.size();
+	while (left > 0) {
+		ssize_t n = ::write(fd, data, left);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		data += n;
+		left -= n;
+	}
+}
+
+void bracketed_paste(bool enable)
+{
+	static bool defined = false;
+	if (!defined) {
+		define_key("\x1b[200~", key_paste_begin);
+		define_key("\x1b[201~", key_paste_end);
+		defined = true;
+	}
+
+	terminal_write(enable ? "\x1b[?2004h" : "\x1b[?2004l");
+}
+
+// Recorder
+void Recorder::_varint(uint64_t v) {
+	while (v >= 0x80) {
+		std::fputc((int) ((v & 0x7F) | 0x80), _file);
+		v >>= 7;
+	}
+
+	std::fputc((int) v, _file);
+}
+
+Recorder::Recorder(const std::string &path) {
+	_file = std::fopen(path.c_str(), "wb");
+	if (_file)
+		std::fwrite(magic, 1, sizeof(magic) - 1, _file);
+}
+
+Recorder::~Recorder() {
+	detach();
+	if (_file)
+		std::fclose(_file);
+}
+
+void Recorder::attach() {
+	_current = this;
+	_last = std::chrono::steady_clock::now();
+}
+
+void Recorder::detach() {
+	if (_current != this)
+		return;
+
+	_current = nullptr;
+	if (_file)
+		std::fflush(_file);
+}
+
+void Recorder::record(int key, bool block) {
+	if (!_file || key < 0)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	auto delay = std::chrono::duration_cast
+		<std::chrono::microseconds> (now - _last);
+	_last = now;
+
+	_varint(delay.count());
+	_varint(((uint64_t) key << 1) | block);
+}
+
+// Replayer
+bool Replayer::_varint(std::FILE *file, uint64_t &v) {
+	v = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		int c = std::fgetc(file);
+		if (c == EOF)
+			return false;
+
+		v |= (uint64_t) (c & 0x7F) << shift;
+		if (!(c & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+void Replayer::_schedule() {
+	if (_next < _events.size())
+		_due += std::chrono::microseconds(_events[_next].delay);
+}
+
+Replayer::Replayer(const std::string &path, Speed speed)
+		: _speed(speed) {
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (!file)
+		return;
+
+	// Check the signature, the first version had no frames (so
+	// 	every key is a frame of its own)
+	char header[sizeof(Recorder::magic) - 1];
+	size_t n = std::fread(header, 1, sizeof(header), file);
+	size_t version = sizeof(header) - 1;
+	_good = (n == sizeof(header))
+		&& !std::memcmp(header, Recorder::magic, version)
+		&& (header[version] == 1 || header[version] == 2);
+
+	bool frames = _good && header[version] == 2;
+
+	uint64_t delay, key;
+	while (_good && _varint(file, delay) && _varint(file, key)) {
+		if (frames)
+			_events.push_back(Event {delay, (int) (key >> 1), (bool) (key & 1)});
+		else
+			_events.push_back(Event {delay, (int) key, true});
+	}
+
+	std::fclose(file);
+}
+
+void Replayer::attach() {
+	_current = this;
+	_next = 0;
+	_due = std::chrono::steady_clock::now();
+	_schedule();
+}
+
+void Replayer::detach() {
+	if (_current == this)
+		_current = nullptr;
+}
+
+int Replayer::next(bool block) {
+	if (_next >= _events.size())
+		return block ? _end_key : ERR;
+
+	// Keys of the next frame wait for the next blocking read
+	if (!block && _events[_next].frame)
+		return ERR;
+
+	if (_speed == Speed::real_time) {
+		auto now = std::chrono::steady_clock::now();
+		if (now < _due) {
+			if (!block)
+				return ERR;
+
+			std::this_thread::sleep_until(_due);
+		}
+	}
+
+	int key = _events[_next++].key;
+	_schedule();
+
+	return key;
+}
+
+// Key input
+int read_key(WINDOW *win, bool block)
+{
+	if (Replayer *replayer = Replayer::current())
+		return replayer->next(block);
+
+	// Sessions wait for input without holding up the others
+	Screen *screen = Screen::current();
+	bool wait = block && screen;
+
+	int c;
+	do {
+		if (wait && !screen->wait())
+			return ERR;
+
+		nodelay(win, !block || wait);
+		c = wgetch(win);
+		nodelay(win, false);
+	} while (wait && c == ERR);
+
+	if (Recorder *recorder = Recorder::current())
+		recorder->record(c, block);
+
+	return c;
+}
+
+// HeadlessScreen
+HeadlessScreen::HeadlessScreen(int height, int width, const char *term)
+		: Screen("/dev/null", term),
+		_guard(std::make_unique <Guard> (this)) {
+	if (good())
+		resizeterm(height, width);
+}
+
+// WindowPool
+
+// Free windows by session and size
+using PoolKey = std::tuple <Screen *, int, int>;
+static std::map <PoolKey, std::vector <WINDOW *>> free_windows;
+
+WINDOW *WindowPool::acquire(int height, int width, int y, int x) {
+	auto it = free_windows.find(PoolKey {Screen::current(), height, width});
+	if (it == free_windows.end() || it->second.empty())
+		return newwin(height, width, y, x);
+
+	WINDOW *win = it->second.back();
+	it->second.pop_back();
+
+	if (mvwin(win, y, x) == ERR) {
+		delwin(win);
+		return newwin(height, width, y, x);
+	}
+
+	// Undo whatever the last owner left behind
+	wbkgdset(win, ' ');
+	wattrset(win, A_NORMAL);
+	scrollok(win, false);
+	keypad(win, false);
+	werase(win);
+	wmove(win, 0, 0);
+
+	return win;
+}
+
+void WindowPool::release(WINDOW *win) {
+	if (!win)
+		return;
+
+	auto &free = free_windows[PoolKey {Screen::current(), getmaxy(win), getmaxx(win)}];
+	if (free.size() < _capacity)
+		free.push_back(win);
+	else
+		delwin(win);
+}
+
+void WindowPool::clear(Screen *screen) {
+	for (auto it = free_windows.begin(); it != free_windows.end(); ) {
+		if (std::get <0> (it->first) != screen) {
+			it++;
+			continue;
+		}
+
+		for (WINDOW *win : it->second)
+			delwin(win);
+
+		it = free_windows.erase(it);
+	}
+}
+
+size_t WindowPool::size() {
+	size_t n = 0;
+	for (const auto &[key, free] : free_windows)
+		n += free.size();
+
+	return n;
+}
+
+// Window
+std::pair <int, int> Window::limits() {
+	int max_height, max_width;
+	getmaxyx(stdscr, max_height, max_width);
+	return std::make_pair(max_height, max_width);
+}
+
+// PlainWindow
+PlainWindow::PlainWindow(int height, int width, int y, int x)
+		: Window(height, width, y, x) {
+	// Create the windows
+	_main = WindowPool::acquire(height, width, y, x);
+}
+
+PlainWindow::PlainWindow(const ScreenInfo &i)
+		: Window(i) {
+	// Create the windows
+	_main = WindowPool::acquire(info.height, info.width, info.y, info.x);
+}
+
+void PlainWindow::_release() {
+	if (!_main)
+		return;
+
+	Screen::Guard guard(_screen);
+
+	// Paints the windows staged by the derived classes too
+	werase(_main);
+	refresh_window(_main);
+	WindowPool::release(_main);
+	_main = nullptr;
+}
+
+PlainWindow &PlainWindow::operator=(PlainWindow &&other) noexcept {
+	if (this != &other) {
+		_release();
+
+		Window::operator=(std::move(other));
+		_main = std::exchange(other._main, nullptr);
+	}
+
+	return *this;
+}
+
+PlainWindow::~PlainWindow() {
+	_release();
+}
+
+void PlainWindow::add_char(const chtype ch) const {
+	waddch(_main, ch);
+	refresh_window(_main);
+}
+
+void PlainWindow::mvadd_char(int y, int x, const chtype ch) const {
+	mvwaddch(_main, y, x, ch);
+	refresh_window(_main);
+}
+
+int PlainWindow::try_getc() const {
+	// Get a character without blocking, ERR if there is none
+	return read_key(_main, false);
+}
+
+std::string PlainWindow::read_paste() const {
+	std::string text;
+
+	while (text.size() < paste_limit) {
+		// A recording can run out in the middle of a paste
+		Replayer *replayer = Replayer::current();
+		if (replayer && replayer->done())
+			break;
+
+		int c = read_key(_main, true);
+		if (c == ERR || c == key_paste_end)
+			break;
+
+		// Drop anything decoded as a special key
+		if (c <= 0xFF)
+			text += (char) c;
+	}
+
+	return text;
+}
+
+int PlainWindow::getc() const {
+	// Input ends the frame for the renderer (staging the window
+	// 	first keeps wgetch from refreshing through curses)
+	if (Renderer *renderer = Renderer::current()) {
+		refresh_window(_main);
+		renderer->present();
+	}
+
+	return read_key(_main, true);
+}
+
+void PlainWindow::set_keypad(bool bl) {
+	// Set keypad options
+	keypad(_main, bl);
+}
+
+// BoxedWindow
+BoxedWindow::BoxedWindow(int height, int width, int y, int x)
+		: PlainWindow(height, width, y, x) {
+	// Create the windows (the plain window's goes back to the
+	// 	pool, and is likely to be picked up as the box)
+	WindowPool::release(_main);
+	_box = WindowPool::acquire(height, width, y, x);
+	_main = WindowPool::acquire(height - 2, width - 2, y + 1, x + 1);
+
+	// Borders
+	box(_box, 0, 0);
+
+	// Painted along with the first frame
+	stage_window(_box);
+}
+
+BoxedWindow::BoxedWindow(const ScreenInfo &i)
+		: PlainWindow(i) {
+	// Create the windows (the plain window's goes back to the
+	// 	pool, and is likely to be picked up as the box)
+	WindowPool::release(_main);
+	_box = WindowPool::acquire(info.height, info.width, info.y, info.x);
+	_main = WindowPool::acquire(info.height - 2, info.width - 2, info.y + 1, info.x + 1);
+
+	// Borders
+	box(_box, 0, 0);
+
+	// Painted along with the first frame
+	stage_window(_box);
+}
+
+void BoxedWindow::_release_box() {
+	if (!_box)
+		return;
+
+	Screen::Guard guard(_screen);
+
+	// Give back the windows (painted by the plain window)
+	werase(_box);
+	stage_window(_box);
+	WindowPool::release(_box);
+	_box = nullptr;
+}
+
+BoxedWindow &BoxedWindow::operator=(BoxedWindow &&other) noexcept {
+	if (this != &other) {
+		_release_box();
+
+		PlainWindow::operator=(std::move(other));
+		_box = std::exchange(other._box, nullptr);
+	}
+
+	return *this;
+}
+
+BoxedWindow::~BoxedWindow() {
+	_release_box();
+}
+
+// DecoratedWindow
+DecoratedWindow::DecoratedWindow(const std::string &title, int height, int width, int y, int x)
+		: BoxedWindow(height, width, y, x), _title_str(title) {
+	// Create the windows
+	WindowPool::release(_main);
+	_main = WindowPool::acquire(height - 5, width - 2, y + 4, x + 1);
+	_title = WindowPool::acquire(3, width - 2, y + 1, x + 1);
+
+	// Borders
+	box(_title, 0, 0);
+
+	// Write title
+	int remaining = (width - 2) - display_width(title);
+	mvwprintw(_title, 1, remaining/2, "%s", title.c_str());
+
+	// Painted along with the first frame
+	stage_window(_title);
+}
+
+void DecoratedWindow::_release_title() {
+	if (!_title)
+		return;
+
+	Screen::Guard guard(_screen);
+
+	// Give back the windows (painted by the plain window)
+	werase(_title);
+	stage_window(_title);
+	WindowPool::release(_title);
+	_title = nullptr;
+}
+
+DecoratedWindow &DecoratedWindow::operator=(DecoratedWindow &&other) noexcept {
+	if (this != &other) {
+		_release_title();
+
+		BoxedWindow::operator=(std::move(other));
+		_title = std::exchange(other._title, nullptr);
+		_title_str = std::move(other._title_str);
+	}
+
+	return *this;
+}
+
+DecoratedWindow::~DecoratedWindow() {
+	_release_title();
+}
+
+void DecoratedWindow::refresh() const {
+	stage_window(_title);
+	BoxedWindow::refresh();
+}
+
+void DecoratedWindow::attr_title(int attr) {
+	wattron(_title, attr);
+
+	int remaining = (info.width - 2) - display_width(_title_str);
+	mvwprintw(_title, 1, remaining/2, "%s", _title_str.c_str());
+
+	wattroff(_title, attr);
+	refresh_window(_title);
+}
+
+// SelectionWindow
+void SelectionWindow::_handle_key(int c, Selection &selected) {
+	auto it = _keymap.find(c);
+	if (it == _keymap.end())
+		return;
+
+	int size = _option_list.size();
+
+	switch (it->second) {
+	case Action::up:
+		_line--;
+		break;
+	case Action::down:
+		_line++;
+		break;
+	case Action::cancel:
+		// TODO: undo all selections if ESC is pressed
+		_terminate = true;
+		break;
+	case Action::select:
+		if (!_option.multi) {
+			selected.insert(_line);
+			_terminate = true;
+		} else {
+			// Check if on the OK key
+			if (_line == size) {
+				_terminate = true;
+				return;
+			}
+
+			if (selected.find(_line) == selected.end())
+				selected.insert(_line);
+			else
+				selected.erase(_line);
+		}
+		break;
+	}
+
+	// Allow overflow if multi
+	if (_option.multi)
+		_line = std::max(0, std::min(_line, size));
+	else
+		_line = std::max(0, std::min(_line, size - 1));
+}
+
+void SelectionWindow::_print_ok(bool highlight) {
+	if (highlight)
+		attribute_set(A_REVERSE);
+
+	mvwprintw(_main, info.height - 6, info.width / 2 - 4, "[ OK ]");
+
+	if (highlight)
+		attribute_set(A_NORMAL);
+}
+
+SelectionWindow::SelectionWindow(const std::string &title, const ScreenInfo &info,
+		const OptionList &option_list,
+		const Option &option)
+		: DecoratedWindow(title, info),
+		_option_list(option_list),
+		_option(option),
+		_keymap {
+			{KEY_UP, Action::up},
+			{KEY_DOWN, Action::down},
+			{10, Action::select},
+			{KEY_ENTER, Action::select},
+			{27, Action::cancel}
+		} {
+	// Preprocess the options list if centered
+	if (_option.centered) {
+		// Pad to the window width
+		int width = info.width - 4;
+		for (auto &str : _option_list) {
+			int len = display_width(str);
+			int pad_left = (width - len) / 2;
+			int pad_right = width - len - pad_left;
+
+			str.insert(0, pad_left, ' ');
+			str.append(pad_right, ' ');
+		}
+	}
+}
+
+void SelectionWindow::bind(int key, Action action) {
+	_keymap[key] = action;
+}
+
+void SelectionWindow::unbind(int key) {
+	_keymap.erase(key);
+}
+
+void SelectionWindow::_begin() {
+	_terminate = false;
+
+	// No echo, no cursor
+	noecho();
+	curs_set(0);
+
+	// Keyboard
+	// TODO: method
+	keypad(_main, true);
+}
+
+void SelectionWindow::_draw(const Selection &selected) {
+	// Reprint all options
+	for (int i = 0; i < (int) _option_list.size(); i++) {
+		// Hghlight if selected or hovering
+		if (selected.count(i) || i == _line)
+			attribute_on(A_REVERSE);
+		mvwprintw(_main, i, 1, "%s", _option_list[i].c_str());
+		attribute_set(A_NORMAL);
+	}
+
+	// Print ok button if multiselect
+	if (_option.multi)
+		_print_ok((size_t) _line == _option_list.size());
+
+	// Refresh
+	refresh();
+}
+
+bool SelectionWindow::yield(Selection &selected) {
+	// TODO: ok button if multiselect
+	_begin();
+
+	// Loop
+	while (!_terminate) {
+		_draw(selected);
+
+		// Key handling, applying all pending keys
+		// 	before drawing the next frame
+		int c = getc();
+		do {
+			_handle_key(c, selected);
+		} while (!_terminate && (c = try_getc()) != ERR);
+	}
+
+	return selected.size() > 0;
+}
+
+// TreeView
+TreeView::Path TreeView::_path(const Node *node) {
+	Path path;
+	for (; node; node = node->parent)
+		path.push_back(node->label);
+
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+std::vector <std::unique_ptr <TreeView::Node>> TreeView::_load(Node *parent) {
+	Entries entries = _fetch(parent ? _path(parent) : Path {});
+
+	std::vector <std::unique_ptr <Node>> nodes;
+	nodes.reserve(entries.size());
+	for (const auto &e : entries) {
+		nodes.emplace_back(new Node {
+			e.label, e.leaf,
+			parent ? parent->depth + 1 : 0,
+			parent,
+			false, false, {}
+		});
+	}
+
+	_loaded += nodes.size();
+	return nodes;
+}
+
+size_t TreeView::_count(const Node *node) {
+	size_t count = node->children.size();
+	for (const auto &child : node->children)
+		count += _count(child.get());
+
+	return count;
+}
+
+void TreeView::_collect(Node *node, std::vector <Node *> &rows) {
+	for (const auto &child : node->children) {
+		rows.push_back(child.get());
+		if (child->expanded)
+			_collect(child.get(), rows);
+	}
+}
+
+void TreeView::_evict(Node *node) {
+	for (const auto &child : node->children) {
+		if (_loaded <= _option.max_nodes)
+			return;
+
+		if (child->loaded && !child->expanded) {
+			_loaded -= _count(child.get());
+			child->children.clear();
+			child->children.shrink_to_fit();
+			child->loaded = false;
+		} else if (child->expanded) {
+			_evict(child.get());
+		}
+	}
+}
+
+void TreeView::_evict() {
+	if (_option.max_nodes == 0 || _loaded <= _option.max_nodes)
+		return;
+
+	for (const auto &root : _roots) {
+		if (root->loaded && !root->expanded) {
+			_loaded -= _count(root.get());
+			root->children.clear();
+			root->children.shrink_to_fit();
+			root->loaded = false;
+		} else if (root->expanded) {
+			_evict(root.get());
+		}
+
+		if (_loaded <= _option.max_nodes)
+			return;
+	}
+}
+
+void TreeView::_expand(size_t row) {
+	Node *node = _rows[row];
+	if (node->leaf || node->expanded)
+		return;
+
+	if (!node->loaded) {
+		node->children = _load(node);
+		node->loaded = true;
+	}
+
+	node->expanded = true;
+
+	std::vector <Node *> rows;
+	_collect(node, rows);
+	_rows.insert(_rows.begin() + row + 1, rows.begin(), rows.end());
+
+	_evict();
+}
+
+void TreeView::_collapse(size_t row) {
+	Node *node = _rows[row];
+	if (!node->expanded)
+		return;
+
+	node->expanded = false;
+
+	size_t end = row + 1;
+	while (end < _rows.size() && _rows[end]->depth > node->depth)
+		end++;
+
+	_rows.erase(_rows.begin() + row + 1, _rows.begin() + end);
+}
+
+void TreeView::_scroll() {
+	size_t page = _page();
+	if (_line < _offset)
+		_offset = _line;
+	else if (_line >= _offset + page)
+		_offset = _line - page + 1;
+}
+
+void TreeView::_handle_key(int c) {
+	auto it = _keymap.find(c);
+	if (it == _keymap.end() || _rows.empty())
+		return;
+
+	size_t last = _rows.size() - 1;
+	Node *node = _rows[_line];
+
+	switch (it->second) {
+	case Action::up:
+		if (_line > 0)
+			_line--;
+		break;
+	case Action::down:
+		if (_line < last)
+			_line++;
+		break;
+	case Action::page_up:
+		_line -= std::min(_line, _page());
+		break;
+	case Action::page_down:
+		_line = std::min(last, _line + _page());
+		break;
+	case Action::expand:
+		_expand(_line);
+		break;
+	case Action::collapse:
+		// Collapsed nodes go up to their parent
+		if (node->expanded) {
+			_collapse(_line);
+		} else if (node->parent) {
+			while (_rows[_line] != node->parent)
+				_line--;
+		}
+		break;
+	case Action::toggle:
+		if (node->expanded)
+			_collapse(_line);
+		else
+			_expand(_line);
+		break;
+	case Action::select:
+		_selected = true;
+		_terminate = true;
+		break;
+	case Action::cancel:
+		_terminate = true;
+		break;
+	}
+
+	_scroll();
+}
+
+void TreeView::_write_rows() const {
+	werase(_main);
+
+	int width = info.width - 2;
+	size_t end = std::min(_rows.size(), _offset + _page());
+	for (size_t i = _offset; i < end; i++) {
+		const Node *node = _rows[i];
+		int y = i - _offset;
+
+		if (i == _line)
+			wattrset(_main, A_REVERSE);
+
+		int indent = 2 * node->depth;
+		mvwprintw(_main, y, 0, "%*s", indent, "");
+
+		chtype marker = ' ';
+		if (!node->leaf)
+			marker = node->expanded ? ACS_DARROW : ACS_RARROW;
+		waddch(_main, marker);
+		waddch(_main, ' ');
+
+		int room = std::max(0, width - indent - 2);
+		wprintw(_main, "%s", pad_width(node->label, room).c_str());
+
+		if (i == _line)
+			wattrset(_main, A_NORMAL);
+	}
+}
+
+void TreeView::_draw() const {
+	_write_rows();
+	refresh_window(_main);
+}
+
+TreeView::TreeView(const std::string &title, const ScreenInfo &info,
+		const Fetch &fetch, const Option &option)
+		: DecoratedWindow(title, info),
+		_fetch(fetch), _option(option),
+		_keymap {
+			{KEY_UP, Action::up},
+			{KEY_DOWN, Action::down},
+			{KEY_PPAGE, Action::page_up},
+			{KEY_NPAGE, Action::page_down},
+			{KEY_RIGHT, Action::expand},
+			{KEY_LEFT, Action::collapse},
+			{' ', Action::toggle},
+			{10, Action::select},
+			{KEY_ENTER, Action::select},
+			{27, Action::cancel}
+		} {
+	_roots = _load(nullptr);
+	for (const auto &root : _roots)
+		_rows.push_back(root.get());
+
+	// Painted along with the first frame
+	_write_rows();
+	stage_window(_main);
+}
+
+void TreeView::bind(int key, Action action) {
+	_keymap[key] = action;
+}
+
+void TreeView::unbind(int key) {
+	_keymap.erase(key);
+}
+
+bool TreeView::yield(Path &selected) {
+	noecho();
+	curs_set(0);
+	keypad(_main, true);
+
+	_terminate = false;
+	_selected = false;
+
+	while (!_terminate) {
+		_draw();
+
+		// Apply all pending keys before drawing the next frame
+		int c = getc();
+		do {
+			_handle_key(c);
+		} while (!_terminate && (c = try_getc()) != ERR);
+	}
+
+	if (_selected && !_rows.empty())
+		selected = _path(_rows[_line]);
+
+	return _selected;
+}
+
+// DelimitedReader
+void DelimitedReader::_split(const char *begin, const char *end, Record &record) const {
+	while (true) {
+		auto next = (const char *) std::memchr(begin, _opt.delimiter, end - begin);
+		if (!next) {
+			record.emplace_back(begin, end);
+			return;
+		}
+
+		record.emplace_back(begin, next);
+		begin = next + 1;
+	}
+}
+
+size_t DelimitedReader::_split_quoted(const char *begin, const char *end, Record &record, bool last) const {
+	std::string field;
+	bool quoted = false;
+
+	const char *p = begin;
+	for (; p < end; p++) {
+		char c = *p;
+		if (quoted) {
+			if (c != '"') {
+				field += c;
+			} else if (p + 1 < end && p[1] == '"') {
+				// Escaped quote
+				field += '"';
+				p++;
+			} else if (p + 1 == end && !last) {
+				// Can't tell an escaped quote yet
+				return 0;
+			} else {
+				quoted = false;
+			}
+		} else if (c == '"') {
+			quoted = true;
+		} else if (c == _opt.delimiter) {
+			record.push_back(std::move(field));
+			field.clear();
+		} else if (c == '\n') {
+			break;
+		} else {
+			field += c;
+		}
+	}
+
+	// Record runs past the bytes read so far
+	if (p == end && !last)
+		return 0;
+
+	if (!field.empty() && field.back() == '\r' && !quoted)
+		field.pop_back();
+
+	record.push_back(std::move(field));
+	return (p < end) ? p - begin + 1 : p - begin;
+}
+
+void DelimitedReader::_scan(std::vector <Record> &records) {
+	const char *data = _buffer.data();
+	const char *end = data + _buffer.size();
+
+	while (_start < _buffer.size()) {
+		const char *begin = data + _start;
+		auto line = (const char *) std::memchr(begin, '\n', end - begin);
+
+		// Quotes are rare, lines without any are split directly
+		const char *stop = line ? line : end;
+		if (_opt.quotes && std::memchr(begin, '"', stop - begin)) {
+			Record record;
+			size_t used = _split_quoted(begin, end, record, _eof);
+			if (!used)
+				break;
+
+			records.push_back(std::move(record));
+			_start += used;
+			continue;
+		}
+
+		if (!line && !_eof)
+			break;
+
+		// Drop the carriage return of CRLF lines
+		const char *last = stop;
+		if (last > begin && last[-1] == '\r')
+			last--;
+
+		// Blank lines are skipped
+		if (last > begin) {
+			Record record;
+			_split(begin, last, record);
+			records.push_back(std::move(record));
+		}
+
+		_start = stop - data + (line != nullptr);
+	}
+
+	// Keep only the partial record
+	if (_start > 0) {
+		_buffer.erase(0, _start);
+		_start = 0;
+	}
+}
+
+bool DelimitedReader::read(std::vector <Record> &records) {
+	if (_eof)
+		return false;
+
+	for (int i = 0; i < _opt.reads && !_eof; i++) {
+		pollfd pfd {_fd, POLLIN, 0};
+		if (poll(&pfd, 1, 0) <= 0)
+			break;
+
+		size_t size = _buffer.size();
+		_buffer.resize(size + _opt.chunk);
+
+		ssize_t n = ::read(_fd, &_buffer[size], _opt.chunk);
+		_buffer.resize(size + std::max(n, (ssize_t) 0));
+
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		if (n < 0 && errno == EAGAIN)
+			break;
+
+		// End of input (or an error), the rest is the last record
+		if (n <= 0)
+			_eof = true;
+	}
+
+	_scan(records);
+	return !_eof;
+}
+
+bool DelimitedReader::wait(int timeout) const {
+	if (_eof)
+		return false;
+
+	pollfd pfd {_fd, POLLIN, 0};
+	int n;
+	do {
+		n = poll(&pfd, 1, timeout);
+	} while (n < 0 && errno == EINTR);
+
+	return n > 0;
+}
+
+// Chart
+Chart::Bucket Chart::_reduce(const float *data, size_t n) {
+	constexpr size_t lanes = 8;
+
+	Bucket b {data[0], data[0], 0, n};
+
+	float lo[lanes], hi[lanes], sum[lanes];
+	for (size_t k = 0; k < lanes; k++) {
+		lo[k] = hi[k] = data[0];
+		sum[k] = 0;
+	}
+
+	size_t i = 0;
+	for (; i + lanes <= n; i += lanes) {
+		for (size_t k = 0; k < lanes; k++) {
+			float v = data[i + k];
+			lo[k] = v < lo[k] ? v : lo[k];
+			hi[k] = v > hi[k] ? v : hi[k];
+			sum[k] += v;
+		}
+	}
+
+	for (size_t k = 0; k < lanes; k++) {
+		b.lo = std::min(b.lo, lo[k]);
+		b.hi = std::max(b.hi, hi[k]);
+		b.sum += sum[k];
+	}
+
+	for (; i < n; i++) {
+		b.lo = std::min(b.lo, data[i]);
+		b.hi = std::max(b.hi, data[i]);
+		b.sum += data[i];
+	}
+
+	return b;
+}
+
+Chart::Bucket Chart::_reduce_range(size_t begin, size_t end) const {
+	size_t cap = _ring.size();
+	size_t start = begin % cap;
+	size_t n = end - begin;
+
+	// No wrap around
+	if (start + n <= cap)
+		return _reduce(&_ring[start], n);
+
+	size_t head = cap - start;
+	Bucket a = _reduce(&_ring[start], head);
+	Bucket b = _reduce(&_ring[0], n - head);
+
+	return Bucket {
+		std::min(a.lo, b.lo),
+		std::max(a.hi, b.hi),
+		a.sum + b.sum,
+		n
+	};
+}
+
+size_t Chart::_bucket_size() const {
+	size_t retained = _retained();
+	size_t columns = std::max <size_t> (_columns(), 1);
+
+	return std::max(_option.per_column, (retained + columns - 1) / columns);
+}
+
+void Chart::_rebuild() {
+	_buckets.clear();
+	_per = _bucket_size();
+	if (_count == 0)
+		return;
+
+	// Buckets stay aligned to absolute indices, so the
+	// 	oldest one may only be partly retained
+	size_t oldest = _count - _retained();
+	size_t last = (_count - 1) / _per;
+
+	_first = oldest / _per;
+	if (last + 1 - _first > _columns())
+		_first = last + 1 - _columns();
+
+	for (size_t b = _first; b <= last; b++) {
+		size_t begin = std::max(b * _per, oldest);
+		size_t end = std::min((b + 1) * _per, _count);
+		_buckets.push_back(_reduce_range(begin, end));
+	}
+}
+
+bool Chart::_fit_range() {
+	if (_option.lo < _option.hi || _buckets.empty())
+		return false;
+
+	float lo = _buckets[0].lo;
+	float hi = _buckets[0].hi;
+	for (const auto &b : _buckets) {
+		if (_option.mode == Mode::average) {
+			float avg = b.sum / b.n;
+			lo = std::min(lo, avg);
+			hi = std::max(hi, avg);
+		} else {
+			lo = std::min(lo, b.lo);
+			hi = std::max(hi, b.hi);
+		}
+	}
+
+	bool changed = (lo != _lo || hi != _hi);
+	_lo = lo;
+	_hi = hi;
+	return changed;
+}
+
+int Chart::_level(float v) const {
+	int levels = 4 * info.height;
+	if (_hi <= _lo)
+		return levels / 2;
+
+	float t = (v - _lo) / (_hi - _lo);
+	int level = t * (levels - 1) + 0.5f;
+	return std::max(0, std::min(level, levels - 1));
+}
+
+std::pair <int, int> Chart::_span(const Bucket &b) const {
+	if (_option.mode == Mode::average)
+		return {0, _level(b.sum / b.n)};
+
+	return {_level(b.lo), _level(b.hi)};
+}
+
+chtype Chart::_glyph(int level) {
+	switch (level % 4) {
+	case 0:
+		return ACS_S9;
+	case 1:
+		return ACS_S7;
+	case 2:
+		return ACS_S3;
+	default:
+		break;
+	}
+
+	return ACS_S1;
+}
+
+void Chart::_draw_column(size_t c) const {
+	if (_option.braille) {
+		_draw_braille(c / 2);
+		return;
+	}
+
+	int h = info.height;
+	for (int y = 0; y < h; y++)
+		mvwaddch(_main, y, c, ' ');
+
+	if (c >= _buckets.size())
+		return;
+
+	auto [llo, lhi] = _span(_buckets[c]);
+	int top = h - 1 - lhi / 4;
+	int bottom = h - 1 - llo / 4;
+
+	if (_option.mode == Mode::average) {
+		// Filled bar with a partial top cell
+		for (int y = h - 1; y > top; y--)
+			mvwaddch(_main, y, c, ACS_BLOCK);
+		mvwaddch(_main, top, c, _glyph(lhi));
+	} else if (top == bottom) {
+		mvwaddch(_main, top, c, _glyph(lhi));
+	} else {
+		// Envelope from min to max
+		for (int y = top; y <= bottom; y++)
+			mvwaddch(_main, y, c, ACS_VLINE);
+	}
+}
+
+void Chart::_draw_braille(int x) const {
+#if NCURSES_WIDECHAR
+	// Dot bits of a braille cell, by side and by row from the top
+	static constexpr int dots[2][4] = {
+		{0x01, 0x02, 0x04, 0x40},
+		{0x08, 0x10, 0x20, 0x80}
+	};
+
+	int h = info.height;
+	for (int y = 0; y < h; y++) {
+		int mask = 0;
+
+		// Levels 4 * row .. 4 * row + 3, counted from the bottom
+		int base = 4 * (h - 1 - y);
+		for (int side = 0; side < 2; side++) {
+			size_t c = 2 * x + side;
+			if (c >= _buckets.size())
+				break;
+
+			auto [llo, lhi] = _span(_buckets[c]);
+			int from = std::max(llo, base);
+			int to = std::min(lhi, base + 3);
+			for (int level = from; level <= to; level++)
+				mask |= dots[side][3 - (level - base)];
+		}
+
+		wchar_t wch[2] = {(wchar_t) (mask ? 0x2800 + mask : ' '), 0};
+		cchar_t cell;
+		setcchar(&cell, wch, A_NORMAL, 0, nullptr);
+		mvwadd_wch(_main, y, x, &cell);
+	}
+#else
+	(void) x;
+#endif
+}
+
+void Chart::_draw() const {
+	for (int x = 0; x < info.width; x++) {
+		if (_option.braille)
+			_draw_braille(x);
+		else
+			_draw_column(x);
+	}
+
+	refresh_window(_main);
+}
+
+Chart::Chart(const ScreenInfo &info, const Option &option)
+		: PlainWindow(info), _option(option) {
+	if (_option.per_column == 0)
+		_option.per_column = 1;
+
+#if !NCURSES_WIDECHAR
+	_option.braille = false;
+#endif
+
+	// By default, just the window's worth of samples
+	size_t capacity = _option.capacity;
+	if (capacity == 0)
+		capacity = std::max <size_t> (_columns(), 1) * _option.per_column;
+	_ring.resize(capacity);
+	_per = _option.per_column;
+
+	_lo = _option.lo;
+	_hi = _option.hi;
+}
+
+void Chart::push(float v) {
+	_ring[_count % _ring.size()] = v;
+	_count++;
+
+	// The ring grew past what the buckets can hold
+	if (_bucket_size() != _per) {
+		_rebuild();
+		_fit_range();
+		_draw();
+		return;
+	}
+
+	size_t bucket = (_count - 1) / _per;
+	bool scrolled = false;
+
+	if (!_buckets.empty() && bucket == _first + _buckets.size() - 1) {
+		Bucket &b = _buckets.back();
+		b.lo = std::min(b.lo, v);
+		b.hi = std::max(b.hi, v);
+		b.sum += v;
+		b.n++;
+	} else {
+		_buckets.push_back(Bucket {v, v, v, 1});
+	}
+
+	// Drop buckets that left the ring or the window; a partly
+	// 	overwritten oldest bucket keeps its reduction until then
+	size_t oldest = _count - _retained();
+	while (!_buckets.empty() && ((_first + 1) * _per <= oldest
+			|| _buckets.size() > _columns())) {
+		_buckets.erase(_buckets.begin());
+		_first++;
+		scrolled = true;
+	}
+
+	if (_fit_range() || scrolled) {
+		_draw();
+	} else {
+		_draw_column(_buckets.size() - 1);
+		refresh_window(_main);
+	}
+}
+
+void Chart::push(const float *data, size_t n) {
+	size_t cap = _ring.size();
+
+	// Only the last capacity samples survive
+	if (n > cap) {
+		_count += n - cap;
+		data += n - cap;
+		n = cap;
+	}
+
+	for (size_t i = 0; i < n; i++)
+		_ring[(_count + i) % cap] = data[i];
+	_count += n;
+
+	_rebuild();
+	_fit_range();
+	_draw();
+}
+
+void Chart::set_range(float lo, float hi) {
+	_option.lo = lo;
+	_option.hi = hi;
+
+	_lo = lo;
+	_hi = hi;
+
+	_fit_range();
+	_draw();
+}
+
+void Chart::reset() {
+	_count = 0;
+	_first = 0;
+	_per = _option.per_column;
+	_buckets.clear();
+	_draw();
+}
+
+// ProgressBoard
+int ProgressBoard::_bar_width() const {
+	// Label, brackets, spaces and percentage
+	return std::max(1, info.width - 2 - (int) _label_width - 9);
+}
+
+void ProgressBoard::_invalidate() {
+	for (auto &task : _tasks)
+		task._filled = task._percent = -1;
+	werase(_main);
+}
+
+bool ProgressBoard::_draw_task(Task &task, int line) {
+	size_t done = task.done();
+	size_t total = task.total();
+
+	double ratio = (total > 0) ? std::min(1.0, (double) done / total) : 1.0;
+
+	int width = _bar_width();
+	int filled = ratio * width;
+	int percent = ratio * 100;
+
+	if (filled == task._filled && percent == task._percent)
+		return false;
+
+	task._filled = filled;
+	task._percent = percent;
+
+	mvwprintw(_main, line, 0, "%s [",
+		pad_width(task._label, _label_width).c_str());
+	for (int i = 0; i < width; i++)
+		waddch(_main, i < filled ? ACS_BLOCK : ' ');
+	wprintw(_main, "] %3d%%", percent);
+
+	return true;
+}
+
+ProgressBoard::Task &ProgressBoard::add(const std::string &label, size_t total) {
+	_tasks.emplace_back(label, total);
+
+	// Longer labels shift every bar
+	size_t limit = std::max(0, info.width / 3);
+	size_t width = std::min(display_width(label), limit);
+	if (width > _label_width) {
+		_label_width = width;
+		_invalidate();
+	}
+
+	return _tasks.back();
+}
+
+void ProgressBoard::scroll_tasks(int lines) {
+	int max = std::max(0, (int) _tasks.size() - _rows());
+	_offset = std::max(0, std::min(_offset + lines, max));
+	_invalidate();
+}
+
+bool ProgressBoard::sample() {
+	// Checked before drawing, so that the last frame drawn shows
+	// 	the tasks finished
+	bool finished = true;
+	for (const auto &task : _tasks)
+		finished &= task.finished();
+
+	bool changed = false;
+
+	int rows = _rows();
+	for (int i = 0; i < rows && _offset + i < (int) _tasks.size(); i++)
+		changed |= _draw_task(_tasks[_offset + i], i);
+
+	if (changed) {
+		refresh_window(_main);
+		present_frame();
+	}
+
+	return finished;
+}
+
+void ProgressBoard::run(std::chrono::milliseconds period) {
+	while (!sample())
+		Screen::sleep(period.count());
+}
+
+// Completions
+Completions::Completions(std::vector <std::string> words) : _words(std::move(words)) {
+	std::sort(_words.begin(), _words.end());
+	_words.erase(std::unique(_words.begin(), _words.end()), _words.end());
+}
+
+Completions::Range Completions::range(const std::string &prefix) const {
+	Range range {0, _words.size()};
+	for (size_t i = 0; i < prefix.size() && range.first < range.second; i++)
+		range = narrow(range, i, prefix[i]);
+
+	return range;
+}
+
+Completions::Range Completions::narrow(Range range, size_t depth, unsigned char byte) const {
+	// Within the range candidates share the first depth bytes,
+	// 	so they are ordered by the next one (ending ones first)
+	auto next = [depth](const std::string &word) {
+		return depth < word.size() ? (int) (unsigned char) word[depth] : -1;
+	};
+
+	auto begin = _words.begin() + range.first;
+	auto end = _words.begin() + range.second;
+
+	auto first = std::partition_point(begin, end,
+		[&](const std::string &word) { return next(word) < byte; });
+	auto last = std::partition_point(first, end,
+		[&](const std::string &word) { return next(word) == byte; });
+
+	return {first - _words.begin(), last - _words.begin()};
+}
+
+// base_yielder
+base_yielder::Ret base_yielder::paste(const std::string &text) {
+	Ret ret = Ret::RET_NOP;
+	for (char c : text) {
+		if (proc((unsigned char) c) != Ret::RET_NOP)
+			ret = Ret::RET_PLUS;
+	}
+
+	return ret;
+}
+
+// Tyielder <std::string>
+Tyielder <std::string>::Ret Tyielder <std::string>::proc(int ch) {
+	if (ch == KEY_RIGHT) {
+		std::string rest = suggestion();
+		if (rest.empty())
+			return Ret::RET_NOP;
+
+		*value += rest;
+		return Ret::RET_PLUS;
+	} else if (ch == KEY_BACKSPACE) {
+		if (!value->empty()) {
+			// Remove a whole UTF-8 sequence
+			while (value->size() > 1 && (value->back() & 0xC0) == 0x80)
+				value->pop_back();
+
+			value->pop_back();
+
+			// Ranges of the removed bytes are stale, even if
+			// 	the field is typed into again before a redraw
+			if (ranges.size() > value->size() + 1)
+				ranges.resize(value->size() + 1);
+
+			return Ret::RET_DEL;
+		}
+
+		return Ret::RET_NOP;
+	} else if (ch >= 0x80 && ch <= 0xFF) {
+		// Bytes of a UTF-8 sequence
+		*value += (char) ch;
+		return Ret::RET_PLUS;
+	} else if (ch < 0x80 && std::isprint(ch)) {
+		*value += ch;
+		return Ret::RET_PLUS;
+	}
+
+	return Ret::RET_NOP;
+}
+
+Tyielder <std::string>::Ret Tyielder <std::string>::paste(const std::string &text) {
+	size_t size = value->size();
+
+	value->reserve(size + text.size());
+	for (char c : text) {
+		if ((unsigned char) c >= 0x80 || std::isprint((unsigned char) c))
+			*value += c;
+	}
+
+	return (value->size() > size) ? Ret::RET_PLUS : Ret::RET_NOP;
+}
+
+std::string Tyielder <std::string>::suggestion() {
+	if (!completions || value->empty())
+		return "";
+
+	_sync();
+
+	// First candidate longer than the value
+	auto range = ranges.back();
+	for (size_t i = range.first; i < range.second; i++) {
+		const std::string &word = (*completions)[i];
+		if (word.size() > value->size())
+			return word.substr(value->size());
+	}
+
+	return "";
+}
+
+void Tyielder <std::string>::_sync() {
+	if (ranges.size() > value->size() + 1)
+		ranges.resize(value->size() + 1);
+
+	if (ranges.empty())
+		ranges.push_back({0, completions->size()});
+
+	// New bytes narrow the last range, one at a time
+	while (ranges.size() < value->size() + 1) {
+		size_t depth = ranges.size() - 1;
+		ranges.push_back(completions->narrow(ranges.back(), depth, (*value)[depth]));
+	}
+}
+
+// FuzzyFinder
+int FuzzyFinder::_score(const std::string &query, const std::string &candidate) {
+	if (query.empty())
+		return 0;
+
+	int score = 0;
+	int streak = 0;
+	size_t q = 0;
+	size_t first = std::string::npos;
+
+	for (size_t i = 0; i < candidate.size() && q < query.size(); i++) {
+		unsigned char c = candidate[i];
+		if (std::tolower(c) != std::tolower((unsigned char) query[q])) {
+			streak = 0;
+			continue;
+		}
+
+		if (first == std::string::npos)
+			first = i;
+
+		score += 16 + 12 * streak;
+
+		// Bonus for matching the start of a word
+		if (i == 0 || !std::isalnum((unsigned char) candidate[i - 1]))
+			score += 10;
+
+		streak++;
+		q++;
+	}
+
+	if (q < query.size())
+		return -1;
+
+	// Earlier matches rank higher
+	return std::max(1, score - (int) std::min(first, (size_t) 15));
+}
+
+bool FuzzyFinder::_better(const Match &a, const Match &b) {
+	if (a.score != b.score)
+		return a.score > b.score;
+
+	return a.index < b.index;
+}
+
+struct FuzzyFinder::Search {
+	Candidates			candidates;
+
+	std::mutex			mutex;
+	std::condition_variable		cv;
+	bool				stop = false;
+
+	// Current job, starting one cancels the previous
+	// 	generation
+	std::shared_ptr <Job>		job;
+	std::atomic <unsigned>		generation {0};
+
+	// Results of the current job, yet to be collected
+	std::vector <Match>		pending;
+
+	std::vector <std::thread>	workers;
+
+	Search(const Candidates &candidates);
+	~Search();
+
+	// Hand a job to the workers
+	void post(std::shared_ptr <Job> next);
+
+	// Worker loop, and the scoring of a single job
+	void run();
+	void work(Job &current);
+};
+
+FuzzyFinder::Search::Search(const Candidates &candidates) : candidates(candidates) {
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t i = 0; i < threads; i++)
+		workers.emplace_back(&Search::run, this);
+}
+
+FuzzyFinder::Search::~Search() {
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		stop = true;
+		generation.fetch_add(1);
+	}
+
+	cv.notify_all();
+	for (auto &worker : workers)
+		worker.join();
+}
+
+void FuzzyFinder::Search::post(std::shared_ptr <Job> next) {
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+
+		// Workers still on the previous job stop at their next
+		// 	chunk, and their results are dropped
+		next->generation = generation.fetch_add(1) + 1;
+		next->active = workers.size();
+
+		job = std::move(next);
+		pending.clear();
+	}
+
+	cv.notify_all();
+}
+
+void FuzzyFinder::Search::run() {
+	unsigned last = 0;
+
+	std::unique_lock <std::mutex> lock(mutex);
+	while (true) {
+		cv.wait(lock, [&]() {
+			return stop || (job && job->generation != last);
+		});
+
+		if (stop)
+			return;
+
+		// Every worker takes each job once
+		std::shared_ptr <Job> current = job;
+		last = current->generation;
+
+		lock.unlock();
+		work(*current);
+		lock.lock();
+	}
+}
+
+void FuzzyFinder::Search::work(Job &current) {
+	size_t total = current.base ? current.base->size() : candidates.size();
+
+	std::vector <Match> local;
+	while (generation.load(std::memory_order_relaxed) == current.generation) {
+		size_t begin = current.cursor.fetch_add(chunk);
+		if (begin >= total)
+			break;
+
+		size_t end = std::min(total, begin + chunk);
+
+		local.clear();
+		for (size_t i = begin; i < end; i++) {
+			size_t index = current.base ? (*current.base)[i] : i;
+			int score = _score(current.query, candidates[index]);
+			if (score >= 0)
+				local.push_back(Match {score, index});
+		}
+
+		// Stale results are dropped
+		std::lock_guard <std::mutex> lock(mutex);
+		if (generation.load() == current.generation)
+			pending.insert(pending.end(), local.begin(), local.end());
+	}
+
+	current.active.fetch_sub(1);
+}
+
+void FuzzyFinder::_start() {
+	if (!_search)
+		return;
+
+	// Extending a query can only drop matches, so only the
+	// 	previous matches (or the previous candidates, if the
+	// 	job was cut short) need to be rescored
+	std::shared_ptr <const std::vector <size_t>> base;
+	if (_job && !_job->query.empty()
+			&& _query.compare(0, _job->query.size(), _job->query) == 0) {
+		if (!_searching()) {
+			auto indices = std::make_shared <std::vector <size_t>> ();
+			indices->reserve(_results.size());
+			for (const auto &m : _results)
+				indices->push_back(m.index);
+
+			// Keep the candidate order for tie breaking
+			std::sort(indices->begin(), indices->end());
+			base = indices;
+		} else {
+			base = _job->base;
+		}
+	}
+
+	auto job = std::make_shared <Job> ();
+	job->query = _query;
+	job->base = base;
+
+	_search->post(job);
+
+	_job = job;
+	_results.clear();
+	_ranked = 0;
+	_line = _offset = 0;
+}
+
+bool FuzzyFinder::_searching() {
+	if (!_search)
+		return false;
+
+	std::lock_guard <std::mutex> lock(_search->mutex);
+	return (_job && _job->active.load() > 0) || !_search->pending.empty();
+}
+
+void FuzzyFinder::_collect() {
+	if (!_search)
+		return;
+
+	{
+		std::lock_guard <std::mutex> lock(_search->mutex);
+		auto &pending = _search->pending;
+		if (pending.empty())
+			return;
+
+		_results.insert(_results.end(), pending.begin(), pending.end());
+		pending.clear();
+	}
+
+	// Only the results up to the page in view need ordering
+	size_t k = std::min(_results.size(), _offset + _page());
+	std::partial_sort(_results.begin(), _results.begin() + k,
+		_results.end(), _better);
+	_ranked = k;
+}
+
+void FuzzyFinder::_handle_key(int c) {
+	auto it = _keymap.find(c);
+	if (it == _keymap.end()) {
+		// Everything else edits the query
+		Tyielder <std::string> query(&_query);
+		query.proc(c);
+		return;
+	}
+
+	switch (it->second) {
+	case Action::up:
+		if (_line > 0)
+			_line--;
+		break;
+	case Action::down:
+		if (_line + 1 < _results.size())
+			_line++;
+		break;
+	case Action::select:
+		_selected = !_results.empty();
+		_terminate = true;
+		break;
+	case Action::cancel:
+		_terminate = true;
+		break;
+	}
+
+	// Keep the current line in view
+	size_t page = _page();
+	if (_line < _offset)
+		_offset = _line;
+	else if (_line >= _offset + page)
+		_offset = _line - page + 1;
+
+	// Scrolling past the ranked results needs more ranking
+	if (_offset + page > _ranked) {
+		size_t k = std::min(_results.size(), _offset + page);
+		std::partial_sort(_results.begin() + _ranked,
+			_results.begin() + k, _results.end(), _better);
+		_ranked = k;
+	}
+}
+
+void FuzzyFinder::_draw(bool searching) {
+	werase(_main);
+
+	int width = info.width - 2;
+
+	mvwprintw(_main, 0, 0, "> %s", _query.c_str());
+	mvwprintw(_main, 1, 0, "  %zu/%zu%s", _results.size(),
+		_search ? _search->candidates.size() : 0, searching ? " ..." : "");
+
+	size_t end = std::min(_ranked, _offset + _page());
+	for (size_t i = _offset; i < end; i++) {
+		if (i == _line)
+			wattrset(_main, A_REVERSE);
+
+		const std::string &str = _search->candidates[_results[i].index];
+		mvwprintw(_main, 2 + i - _offset, 0, " %s",
+			pad_width(str, std::max(0, width - 1)).c_str());
+
+		if (i == _line)
+			wattrset(_main, A_NORMAL);
+	}
+
+	// Cursor at the end of the query
+	wmove(_main, 0, 2 + display_width(_query));
+	refresh_window(_main);
+}
+
+FuzzyFinder::FuzzyFinder(const std::string &title, const ScreenInfo &info,
+		const Candidates &candidates)
+		: DecoratedWindow(title, info),
+		_search(std::make_unique <Search> (candidates)),
+		_keymap {
+			{KEY_UP, Action::up},
+			{KEY_DOWN, Action::down},
+			{10, Action::select},
+			{KEY_ENTER, Action::select},
+			{27, Action::cancel}
+		} {
+	_start();
+}
+
+void FuzzyFinder::bind(int key, Action action) {
+	_keymap[key] = action;
+}
+
+void FuzzyFinder::unbind(int key) {
+	_keymap.erase(key);
+}
+
+FuzzyFinder::FuzzyFinder(FuzzyFinder &&) = default;
+FuzzyFinder &FuzzyFinder::operator=(FuzzyFinder &&) = default;
+
+FuzzyFinder::~FuzzyFinder() = default;
+
+bool FuzzyFinder::yield(size_t &index) {
+	noecho();
+	curs_set(1);
+	keypad(_main, true);
+
+	_terminate = false;
+	_selected = false;
+
+	while (!_terminate) {
+		bool searching = _searching();
+
+		_collect();
+		_draw(searching);
+
+		// Keep drawing while results stream in
+		int c;
+		if (searching) {
+			c = try_getc();
+			if (c == ERR) {
+				Screen::sleep(16);
+				continue;
+			}
+		} else {
+			c = getc();
+		}
+
+		// Apply all pending keys before the next frame
+		std::string query = _query;
+		do {
+			_handle_key(c);
+		} while (!_terminate && (c = try_getc()) != ERR);
+
+		if (_query != query)
+			_start();
+	}
+
+	curs_set(0);
+
+	if (_selected)
+		index = _results[_line].index;
+
+	return _selected;
+}
+
+// FieldEditor
+struct FieldEditor::Validation {
+	std::vector <Validator>			validators;
+	std::vector <Clock::duration>		debounce;
+
+	// Bumped on every change of a field's value, results
+	// 	for older generations are dropped
+	std::unique_ptr <std::atomic <unsigned>[]>	generation;
+
+	std::mutex				mutex;
+	std::condition_variable			cv;
+	std::atomic <bool>			stop {false};
+
+	// Pending check of each field
+	std::vector <std::string>		values;
+	std::vector <Clock::time_point>		due;
+	std::vector <char>			queued;
+
+	// Latest results, with the generation they are for, and
+	// 	whether they are yet to be shown
+	std::vector <std::string>		results;
+	std::vector <unsigned>			checked;
+	std::vector <char>			fresh;
+
+	// Messages shown, only touched by the UI thread
+	std::vector <std::string>		shown;
+
+	std::thread				worker;
+
+	Validation(size_t fields);
+	~Validation();
+
+	void run();
+};
+
+bool FieldEditor::_check_movement_input(int c, int &field) {
+	auto it = _keymap.find(c);
+	if (it == _keymap.end())
+		return false;
+
+	switch (it->second) {
+	case Action::up:
+		if (field > 0)
+			field--;
+		break;
+	case Action::down:
+		if ((size_t) field < _fields.size())
+			field++;
+		break;
+	case Action::confirm:
+		// Only once all the fields check out
+		if ((size_t) field == _fields.size() && _valid())
+			_quit = true;
+		break;
+	case Action::next:
+		// Cycle through fields
+		if ((size_t) field == _fields.size())
+			field = 0;
+		else
+			field++;
+		break;
+	case Action::cancel:
+		_escape = true;
+		_quit = true;
+		break;
+	}
+
+	return true;
+}
+
+void FieldEditor::_print_ok(bool highlight) {
+	if (highlight)
+		attribute_set(A_REVERSE);
+
+	mvwprintw(_main, info.height - 6, info.width / 2 - 4, "[ OK ]");
+
+	if (highlight)
+		attribute_set(A_NORMAL);
+}
+
+int FieldEditor::_room(int field) const {
+	return info.width - (int) display_width(_fields[field]) - 5;
+}
+
+int FieldEditor::_message_width(int field) const {
+	if (!_validation || _validation->shown[field].empty())
+		return 0;
+
+	// At most half of the line, with a space before it
+	int width = display_width(_validation->shown[field]) + 1;
+	return std::min(width, std::max(_room(field) / 2, 0));
+}
+
+std::string FieldEditor::_visible(int field, const std::vector <Yielder> &yielders) {
+	std::string content = yielders[field]->content();
+
+	int room = _room(field) - _message_width(field);
+	return content.substr(tail_width(content, std::max(room, 0)));
+}
+
+int FieldEditor::_cursor_x(int field, const std::vector <Yielder> &yielders) {
+	return display_width(_fields[field]) + 2
+		+ display_width(_visible(field, yielders));
+}
+
+void FieldEditor::_update_field(int field, const std::vector <Yielder> &yielders) {
+	// Substring to print
+	std::string substr = _visible(field, yielders);
+
+	// First clear the field's line
+	cursor(field, 0);
+	wclrtoeol(_main);
+
+	// Reprint the field line (refreshed with the rest of the frame)
+	mvwprintw(_main, field, 0, "%s  %s",
+		_fields[field].c_str(),
+		substr.c_str()
+	);
+
+	// Suggested completion of the current field, dimmed after
+	// 	the cursor
+	if (field == _field) {
+		std::string rest = yielders[field]->suggestion();
+		int room = _room(field) - _message_width(field) - (int) display_width(substr);
+		if (!rest.empty() && room > 0) {
+			wattron(_main, A_DIM);
+			wprintw(_main, "%s", rest.substr(0, fit_width(rest, room)).c_str());
+			wattroff(_main, A_DIM);
+		}
+	}
+
+	// Validation error at the end of the line
+	int width = _message_width(field);
+	if (width > 1) {
+		wattron(_main, A_BOLD);
+		mvwprintw(_main, field, info.width - 2 - width + 1, "%s",
+			pad_width(_validation->shown[field], width - 1).c_str());
+		wattroff(_main, A_BOLD);
+	}
+}
+
+// Validation
+FieldEditor::Validation::Validation(size_t fields)
+		: validators(fields), debounce(fields),
+		generation(new std::atomic <unsigned> [fields]),
+		values(fields), due(fields), queued(fields, 0),
+		results(fields), checked(fields, 0), fresh(fields, 0),
+		shown(fields) {
+	for (size_t i = 0; i < fields; i++)
+		generation[i] = 0;
+
+	worker = std::thread(&Validation::run, this);
+}
+
+FieldEditor::Validation::~Validation() {
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	cv.notify_all();
+	worker.join();
+}
+
+void FieldEditor::Validation::run() {
+	std::unique_lock <std::mutex> lock(mutex);
+	while (!stop) {
+		// Earliest pending check
+		int next = -1;
+		for (size_t i = 0; i < queued.size(); i++) {
+			if (queued[i] && (next < 0 || due[i] < due[next]))
+				next = i;
+		}
+
+		if (next < 0) {
+			cv.wait(lock);
+			continue;
+		}
+
+		// Debounce: a newer value pushes the check back
+		if (Clock::now() < due[next]) {
+			cv.wait_until(lock, due[next]);
+			continue;
+		}
+
+		queued[next] = 0;
+
+		std::string value = std::move(values[next]);
+		unsigned gen = generation[next].load();
+		Validator validator = validators[next];
+
+		lock.unlock();
+
+		Cancelled cancelled = [this, next, gen]() {
+			return stop || generation[next].load() != gen;
+		};
+
+		std::string result = validator(value, cancelled);
+
+		lock.lock();
+
+		// Results for stale values are dropped
+		if (generation[next].load() == gen) {
+			results[next] = result;
+			checked[next] = gen;
+			fresh[next] = 1;
+		}
+	}
+}
+
+void FieldEditor::_validate(int field, const std::string &value, bool now) {
+	if (!_validation || !_validation->validators[field])
+		return;
+
+	Validation &v = *_validation;
+	{
+		std::lock_guard <std::mutex> lock(v.mutex);
+		v.generation[field]++;
+		v.values[field] = value;
+		v.due[field] = Clock::now() + (now ? Clock::duration(0) : v.debounce[field]);
+		v.queued[field] = 1;
+	}
+
+	v.cv.notify_one();
+}
+
+bool FieldEditor::_validating() const {
+	if (!_validation)
+		return false;
+
+	Validation &v = *_validation;
+
+	std::lock_guard <std::mutex> lock(v.mutex);
+	for (size_t i = 0; i < _fields.size(); i++) {
+		if (v.validators[i] && v.checked[i] != v.generation[i].load())
+			return true;
+	}
+
+	return false;
+}
+
+bool FieldEditor::_collect(const std::vector <Yielder> &yielders) {
+	if (!_validation)
+		return false;
+
+	Validation &v = *_validation;
+
+	std::vector <int> changed;
+	{
+		std::lock_guard <std::mutex> lock(v.mutex);
+		for (size_t i = 0; i < _fields.size(); i++) {
+			if (!v.fresh[i])
+				continue;
+
+			v.fresh[i] = 0;
+			if (v.shown[i] != v.results[i]) {
+				v.shown[i] = v.results[i];
+				changed.push_back(i);
+			}
+		}
+	}
+
+	for (int field : changed)
+		_update_field(field, yielders);
+
+	return !changed.empty();
+}
+
+bool FieldEditor::_valid() const {
+	if (!_validation)
+		return true;
+
+	Validation &v = *_validation;
+
+	std::lock_guard <std::mutex> lock(v.mutex);
+	for (size_t i = 0; i < _fields.size(); i++) {
+		if (!v.validators[i])
+			continue;
+
+		if (v.checked[i] != v.generation[i].load() || !v.results[i].empty())
+			return false;
+	}
+
+	return true;
+}
+
+void FieldEditor::set_validator(int field, const Validator &validator,
+		std::chrono::milliseconds debounce) {
+	if (field < 0 || (size_t) field >= _fields.size())
+		return;
+
+	if (!_validation)
+		_validation = std::make_unique <Validation> (_fields.size());
+
+	std::lock_guard <std::mutex> lock(_validation->mutex);
+	_validation->validators[field] = validator;
+	_validation->debounce[field] = debounce;
+}
+
+std::string FieldEditor::message(int field) const {
+	if (!_validation || field < 0 || (size_t) field >= _fields.size())
+		return "";
+
+	return _validation->shown[field];
+}
+
+FieldEditor::FieldEditor(const std::string &title, const Fields &fnames,
+		const ScreenInfo &info)
+		: DecoratedWindow(title, info), _fields(fnames),
+		_keymap {
+			{KEY_UP, Action::up},
+			{KEY_DOWN, Action::down},
+			{'\t', Action::next},
+			{10, Action::confirm},
+			{KEY_ENTER, Action::confirm},
+			{27, Action::cancel}
+		} {
+	// Pad all fields with spaces
+	size_t max_len = 0;
+	for (const auto &f : _fields)
+		max_len = std::max(max_len, display_width(f));
+
+	for (auto &f : _fields)
+		f = pad_width(f, max_len + 2);
+
+	// Write the fields
+	int line = 0;
+	for (const auto &f : _fields) {
+		mvwprintw(_main, line, 0, "%s ", f.c_str());
+		line++;
+	}
+
+	// Add [ OK ] button (painted along with the first frame)
+	_print_ok(false);
+	stage_window(_main);
+}
+
+void FieldEditor::bind(int key, Action action) {
+	_keymap[key] = action;
+}
+
+void FieldEditor::unbind(int key) {
+	_keymap.erase(key);
+}
+
+FieldEditor::FieldEditor(FieldEditor &&) = default;
+FieldEditor &FieldEditor::operator=(FieldEditor &&) = default;
+
+FieldEditor::~FieldEditor() = default;
+
+void FieldEditor::_begin(const std::vector <Yielder> &yielders) {
+	_field = 0;
+	_quit = false;
+	_escape = false;
+
+	// Set keyboard input
+	keypad(_main, true);
+
+	// Turn off echo
+	noecho();
+
+	// Pastes arrive as a single block
+	bracketed_paste(true);
+
+	// Update all fields, checking the starting values
+	for (int i = 0; i < (int) _fields.size(); i++) {
+		_validate(i, yielders[i]->content(), true);
+		_update_field(i, yielders);
+	}
+
+	_dirty.assign(_fields.size(), false);
+
+	// Move cursor
+	cursor(0, _cursor_x(0, yielders));
+	curs_set(1);
+	refresh_window(_main);
+}
+
+void FieldEditor::_feed(int c, const std::vector <Yielder> &yielders) {
+	// Pastes go to the field in one go
+	if (c == key_paste_begin) {
+		std::string text = read_paste();
+		if ((size_t) _field < _fields.size()
+				&& yielders[_field]->paste(text) != base_yielder::Ret::RET_NOP)
+			_dirty[_field] = true;
+
+		return;
+	}
+
+	// Check for movement inputs, suggestions follow the focus
+	int field = _field;
+	if (_check_movement_input(c, _field)) {
+		if (field != _field) {
+			if ((size_t) field < _fields.size())
+				_update_field(field, yielders);
+			if ((size_t) _field < _fields.size())
+				_update_field(_field, yielders);
+		}
+
+		return;
+	}
+
+	// Yield the field
+	if ((size_t) _field < _fields.size()) {
+		auto ret = yielders[_field]->proc(c);
+		if (ret != base_yielder::Ret::RET_NOP)
+			_dirty[_field] = true;
+	}
+}
+
+void FieldEditor::_draw(const std::vector <Yielder> &yielders) {
+	// Update the changed fields
+	for (int i = 0; i < (int) _fields.size(); i++) {
+		if (_dirty[i]) {
+			_validate(i, yielders[i]->content());
+			_update_field(i, yielders);
+		}
+
+		_dirty[i] = false;
+	}
+
+	// Highlight the ok button if needed
+	if ((size_t) _field >= _fields.size()) {
+		curs_set(0);
+		_print_ok(true);
+	} else {
+		curs_set(1);
+		_print_ok(false);
+
+		// Move the cursor
+		cursor(_field, _cursor_x(_field, yielders));
+	}
+
+	refresh_window(_main);
+}
+
+void FieldEditor::_end() {
+	// Disable cursor
+	curs_set(0);
+	bracketed_paste(false);
+}
+
+bool FieldEditor::yield(const std::vector <Yielder> &yielders) {
+	_begin(yielders);
+
+	int c;
+	while (true) {
+		// Show validation results as they come in
+		if (_collect(yielders))
+			_draw(yielders);
+
+		// Poll while checks are running
+		bool polling = _validating();
+		c = polling ? try_getc() : getc();
+		if (c == ERR && polling) {
+			Screen::sleep(16);
+			continue;
+		}
+
+		if (!c)
+			break;
+
+		// Apply all pending keys before drawing a frame
+		do {
+			_feed(c, yielders);
+		} while (!_quit && (c = try_getc()) != ERR);
+
+		// Check for quit
+		if (_quit)
+			break;
+
+		_draw(yielders);
+	}
+
+	_end();
+
+	return (!_escape);
+}
+
+// Common instantiations
+template class Table <int>;
+template class Table <float>;
+template class Table <double>;
+template class Table <std::string>;
+
+template class NumericTable <float>;
+template class NumericTable <double>;
+
+}
@@ -2,17 +2,488 @@
 #define TUICPP_H_
 
 // Standard headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <unordered_map>
 #include <vector>
 
+// Coroutine support (C++20)
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <exception>
+#include <optional>
+#endif
+
+// POSIX headers
+#include <unistd.h>
+
 // Ncurses
 #include <ncurses.h>
 
 namespace tuicpp {
 
+////////////////////
+// Display widths //
+////////////////////
+
+// Display width of a code point; widths come from wcwidth (so the
+// 	locale must be set first) and are cached for the first two planes
+int char_width(char32_t cp);
+
+// Decode the UTF-8 sequence at i and move past it, invalid
+// 	sequences decode to the replacement character
+char32_t decode_utf8(const std::string &str, size_t &i);
+
+// Display width of a UTF-8 string
+size_t display_width(const std::string &str);
+
+// Length in bytes of the longest prefix which fits in width columns
+size_t fit_width(const std::string &str, size_t width);
+
+// Offset in bytes of the longest suffix which fits in width columns
+size_t tail_width(const std::string &str, size_t width);
+
+// Truncate or pad a string to exactly width columns
+std::string pad_width(const std::string &str, size_t width);
+
+//////////////
+// Sessions //
+//////////////
+
+class Renderer;
+
+// Curses session on a terminal of its own, so that one process can
+// 	serve many terminals (e.g. ptys); sessions are driven under use(),
+// 	which makes the session current and serializes curses across
+// 	threads, while blocking reads wait without holding the lock
+class Screen {
+	std::FILE *_out = nullptr;
+	std::FILE *_in = nullptr;
+	SCREEN *_screen = nullptr;
+
+	// Pad for peeking at keys curses has already read from the
+	// 	terminal (pads are never refreshed by wgetch)
+	WINDOW *_probe = nullptr;
+
+	// Renderer attached to this session
+	Renderer *_renderer = nullptr;
+
+	static inline thread_local Screen *_current = nullptr;
+
+	void _open(int in_fd, int out_fd, const char *term);
+
+	friend class Renderer;
+public:
+	// Makes a session current on this thread for its lifetime
+	class Guard {
+		Screen *_screen;
+		Screen *_previous;
+		bool _locked = false;
+	public:
+		Guard(Screen *screen);
+		~Guard();
+
+		Guard(const Guard &) = delete;
+		Guard &operator=(const Guard &) = delete;
+	};
+
+	// Lets other sessions run for its lifetime, while this thread
+	// 	waits on something other than curses
+	class Unlock {
+		Screen *_screen;
+	public:
+		Unlock();
+		~Unlock();
+
+		Unlock(const Unlock &) = delete;
+		Unlock &operator=(const Unlock &) = delete;
+	};
+
+	// Constructors, on a pair of descriptors (which are duplicated)
+	// 	or on a terminal device; term defaults to $TERM
+	Screen(int in_fd, int out_fd, const char *term = nullptr);
+	Screen(const std::string &tty, const char *term = nullptr);
+
+	// No copying, owns the session
+	Screen(const Screen &) = delete;
+	Screen &operator=(const Screen &) = delete;
+
+	// Destructor
+	~Screen();
+
+	// Whether the session could be created
+	bool good() const {
+		return _screen != nullptr;
+	}
+
+	// Make the session current until the guard goes away
+	Guard use() {
+		return Guard(this);
+	}
+
+	// Descriptors of the terminal (e.g. for a Renderer)
+	int input_fd() const {
+		return _in ? fileno(_in) : -1;
+	}
+
+	int output_fd() const {
+		return _out ? fileno(_out) : -1;
+	}
+
+	// Write out what curses has buffered for the terminal
+	void flush() {
+		if (_out)
+			std::fflush(_out);
+	}
+
+	// Wait for input (up to timeout milliseconds, forever if negative)
+	// 	letting other sessions run meanwhile; keys curses has already
+	// 	buffered count as input; false if the terminal was closed or
+	// 	nothing arrived
+	bool wait(int timeout = -1);
+
+	// Sleep without holding up other sessions (a plain sleep if
+	// 	there is no session in use)
+	static void sleep(int ms);
+
+	// Session in use on this thread, if any
+	static Screen *current() {
+		return _current;
+	}
+};
+
+///////////////////////
+// Rendering backend //
+///////////////////////
+
+// Optional renderer which bypasses curses output: windows are still
+// 	composed by curses, but each frame is read back from the virtual
+// 	screen, diffed against the last frame and written out in a single
+// 	write() call (assumes an ANSI/VT100 compatible terminal)
+class Renderer {
+	int _fd;
+	int _height = 0;
+	int _width = 0;
+	bool _dirty = false;
+
+	// Single cell of the screen, the right half of a wide
+	// 	character is marked by a null character
+	struct Cell {
+		char32_t	ch;
+		attr_t		attr;
+
+		bool operator==(const Cell &other) const {
+			return ch == other.ch && attr == other.attr;
+		}
+
+		bool operator!=(const Cell &other) const {
+			return !(*this == other);
+		}
+	};
+
+	// Front (on the terminal) and back (next frame) cell grids
+	std::vector <Cell> _front;
+	std::vector <Cell> _back;
+
+#if NCURSES_WIDECHAR
+	std::vector <cchar_t> _row;
+#else
+	std::vector <chtype> _row;
+#endif
+
+	// Output buffer, flushed once per frame
+	std::string _buffer;
+
+	// Terminal state while emitting a frame
+	attr_t _attr = A_NORMAL;
+	int _cy = -1;
+	int _cx = -1;
+
+	// Attached renderer, if there is no session in use
+	static inline Renderer *_current = nullptr;
+
+	// Where the attached renderer is kept: the session in use or
+	// 	the process
+	static Renderer *&_slot();
+
+	// Match the grids to the size of the screen
+	void _fit();
+
+	// Read a row of the virtual screen into the back grid
+	void _read_row(int y);
+
+	// Cursor movement
+	void _move(int y, int x);
+
+	// Switch attributes (colors included)
+	void _set_attr(attr_t attr);
+
+	// Append a code point as UTF-8
+	void _encode(char32_t cp);
+
+	// Write a single cell at the cursor
+	void _put(const Cell &c);
+
+	// Diff a single row into the buffer
+	void _diff_row(int y);
+
+	// Write the whole buffer out
+	void _flush();
+public:
+	// Constructor
+	Renderer(int fd = STDOUT_FILENO) : _fd(fd) {}
+
+	// No copying, windows refer to the attached renderer
+	Renderer(const Renderer &) = delete;
+	Renderer &operator=(const Renderer &) = delete;
+
+	// Destructor
+	~Renderer();
+
+	// Route all window refreshes through this renderer
+	void attach();
+
+	// Give output back to curses
+	void detach();
+
+	// Force the next frame to repaint every cell
+	void invalidate();
+
+	// Note that windows have been staged
+	void mark() {
+		_dirty = true;
+	}
+
+	bool dirty() const {
+		return _dirty;
+	}
+
+	// Diff the staged frame and write it out
+	void present();
+
+	// Get the attached renderer (of the session in use), if any
+	static Renderer *current() {
+		return _slot();
+	}
+};
+
+// Refresh a window, staging it for the renderer if one is attached
+void refresh_window(WINDOW *win);
+
+// Stage a window for the next screen update without painting it, so
+// 	that windows drawn together are painted together
+void stage_window(WINDOW *win);
+
+// End a frame without reading a key (e.g. for widgets which repaint on
+// 	a timer): what was staged is presented by the attached renderer,
+// 	curses already painted it otherwise
+void present_frame();
+
+///////////////////
+// Input helpers //
+///////////////////
+
+// Key codes reported around a bracketed paste
+constexpr int key_paste_begin = KEY_MAX + 1;
+constexpr int key_paste_end = KEY_MAX + 2;
+
+// Write a control sequence straight to the terminal (of the
+// 	session in use, if any)
+void terminal_write(const std::string &seq);
+
+// Toggle bracketed paste mode, so that pasted text is reported
+// 	as a single block between key_paste_begin and key_paste_end
+void bracketed_paste(bool enable);
+
+/////////////////////
+// Input recording //
+/////////////////////
+
+// Records the keys read by windows, with their timing, to a compact
+// 	file (delays in microseconds and keys, both as varints); keys
+// 	are flagged when they start a frame, i.e. when they were read
+// 	by a blocking read rather than drained after one
+class Recorder {
+	std::FILE *_file = nullptr;
+	std::chrono::steady_clock::time_point _last;
+
+	// Currently attached recorder
+	static inline Recorder *_current = nullptr;
+
+	// Write an unsigned LEB128 varint
+	void _varint(uint64_t v);
+public:
+	// File signature and format version
+	static constexpr char magic[] = "TUIR\x02";
+
+	// Constructor
+	Recorder(const std::string &path);
+
+	// No copying, windows refer to the attached recorder
+	Recorder(const Recorder &) = delete;
+	Recorder &operator=(const Recorder &) = delete;
+
+	// Destructor
+	~Recorder();
+
+	// Whether the file could be opened
+	bool good() const {
+		return _file != nullptr;
+	}
+
+	// Start recording the keys read by windows
+	void attach();
+
+	// Stop recording
+	void detach();
+
+	// Record a key, with the time since the previous one
+	void record(int key, bool block);
+
+	// Get the attached recorder, if any
+	static Recorder *current() {
+		return _current;
+	}
+};
+
+// Replays recorded keys into windows, either as fast as possible
+// 	or with the recorded timing; either way keys come in the frames
+// 	they were recorded in, non-blocking reads stop at the start of
+// 	the next frame
+class Replayer {
+public:
+	// Replay speed
+	enum class Speed {
+		full,
+		real_time
+	};
+
+	// Recorded key
+	struct Event {
+		uint64_t	delay;
+		int		key;
+		bool		frame;
+	};
+protected:
+	std::vector <Event> _events;
+	size_t _next = 0;
+	bool _good = false;
+
+	Speed _speed;
+
+	// Once the log is exhausted, blocking reads get this key
+	// 	(escape by default, which closes the yielding windows)
+	int _end_key = 27;
+
+	// When the next event is due (real time only)
+	std::chrono::steady_clock::time_point _due;
+
+	// Currently attached replayer
+	static inline Replayer *_current = nullptr;
+
+	// Read an unsigned LEB128 varint
+	static bool _varint(std::FILE *file, uint64_t &v);
+
+	// Schedule the next event
+	void _schedule();
+public:
+	// Constructor
+	Replayer(const std::string &path, Speed speed = Speed::full);
+
+	// No copying, windows refer to the attached replayer
+	Replayer(const Replayer &) = delete;
+	Replayer &operator=(const Replayer &) = delete;
+
+	// Destructor
+	~Replayer() {
+		detach();
+	}
+
+	// Whether the file was a valid recording
+	bool good() const {
+		return _good;
+	}
+
+	// Feed windows with the recorded keys instead of the terminal
+	void attach();
+
+	// Go back to the terminal
+	void detach();
+
+	// Key sent once the recording is over
+	void set_end_key(int key) {
+		_end_key = key;
+	}
+
+	// Next key, or ERR if none is due and not blocking
+	int next(bool block);
+
+	// Whether all the keys have been replayed
+	bool done() const {
+		return _next >= _events.size();
+	}
+
+	// Recorded keys
+	const std::vector <Event> &events() const {
+		return _events;
+	}
+
+	// Get the attached replayer, if any
+	static Replayer *current() {
+		return _current;
+	}
+};
+
+// Read a key for a window, from the attached replayer if there is
+// 	one, and through the attached recorder if there is one
+int read_key(WINDOW *win, bool block);
+
+// Session without a terminal, so that recordings can be replayed
+// 	headlessly (e.g. for benchmarks); it stays in use on the thread
+// 	that created it until it is destroyed
+class HeadlessScreen : public Screen {
+	std::unique_ptr <Guard> _guard;
+public:
+	// Constructor
+	HeadlessScreen(int height = 24, int width = 80, const char *term = "xterm");
+};
+
+// Pool of curses windows by size (per session), so that short lived
+// 	windows such as dialogs reuse the ones of earlier windows
+class WindowPool {
+	static inline size_t _capacity = 8;
+public:
+	// Get a blank window, reusing a free one of the same size
+	static WINDOW *acquire(int height, int width, int y, int x);
+
+	// Give a window back, it is deleted if there are already
+	// 	enough free windows of its size
+	static void release(WINDOW *win);
+
+	// Delete the free windows of a session
+	static void clear(Screen *screen = Screen::current());
+
+	// Free windows kept per size
+	static void set_capacity(size_t capacity) {
+		_capacity = capacity;
+	}
+
+	// Number of free windows
+	static size_t size();
+};
+
 ///////////////////////////
 // Main window hierarchy //
 ///////////////////////////
@@ -27,6 +498,9 @@ struct ScreenInfo {
 
 // Generic window class
 class Window {
+protected:
+	// Session the window was created in, if any
+	Screen *_screen = Screen::current();
 public:
 	ScreenInfo info;
 
@@ -39,15 +513,23 @@ public:
 	Window(const ScreenInfo &i)
 		: info {i} {}
 
+	// Move only, windows own their curses windows
+	Window(const Window &) = delete;
+	Window &operator=(const Window &) = delete;
+
+	Window(Window &&) = default;
+	Window &operator=(Window &&) = default;
+
 	// Destructor
 	virtual ~Window() = default;
 
-	// Get max height and width
-	static std::pair <int, int> limits() {
-		int max_height, max_width;
-		getmaxyx(stdscr, max_height, max_width);
-		return std::make_pair(max_height, max_width);
+	// Session of the window (null for the main terminal)
+	Screen *screen() const {
+		return _screen;
 	}
+
+	// Get max height and width (of the session in use)
+	static std::pair <int, int> limits();
 };
 
 // Plain window, no border
@@ -55,34 +537,35 @@ class PlainWindow : public Window {
 protected:
 	WINDOW *_main = nullptr;
 
+	// Erase and give back the window, if any
+	void _release();
+
 	// TODO: do we need subwindows?
 public:
+	// Longest paste read, in bytes
+	static constexpr size_t paste_limit = 1 << 24;
+
 	// Default constructor
 	PlainWindow() = default;
 
 	// Constructors
-	PlainWindow(int height, int width, int y, int x)
-			: Window(height, width, y, x) {
-		// Create the windows
-		_main = newwin(height, width, y, x);
-	}
+	PlainWindow(int height, int width, int y, int x);
 
-	PlainWindow(const ScreenInfo &i)
-			: Window(i) {
-		// Create the windows
-		_main = newwin(info.height, info.width, info.y, info.x);
-	}
+	PlainWindow(const ScreenInfo &i);
+
+	// Moving takes over the curses window
+	PlainWindow(PlainWindow &&other) noexcept
+			: Window(std::move(other)),
+			_main(std::exchange(other._main, nullptr)) {}
+
+	PlainWindow &operator=(PlainWindow &&other) noexcept;
 
 	// Destructor
-	virtual ~PlainWindow() {
-		werase(_main);
-		wrefresh(_main);
-		delwin(_main);
-	}
+	virtual ~PlainWindow();
 
 	// Refreshing
 	virtual void refresh() const {
-		wrefresh(_main);
+		refresh_window(_main);
 	}
 
 	// Clear screen
@@ -109,35 +592,31 @@ public:
 	template <typename ... Args>
 	void printf(const char *str, Args ... args) const {
 		wprintw(_main, str, args...);
-		wrefresh(_main);
+		refresh_window(_main);
 	}
 
 	template <typename ... Args>
 	void mvprintf(int y, int x, const char *str, Args ... args) const {
 		mvwprintw(_main, y, x, str, args...);
-		wrefresh(_main);
+		refresh_window(_main);
 	}
 
 	// Adding characters
-	void add_char(const chtype ch) const {
-		waddch(_main, ch);
-		wrefresh(_main);
-	}
+	void add_char(const chtype ch) const;
 
-	void mvadd_char(int y, int x, const chtype ch) const {
-		mvwaddch(_main, y, x, ch);
-		wrefresh(_main);
-	}
+	void mvadd_char(int y, int x, const chtype ch) const;
 
 	// Interact
-	int getc() const {
-		return wgetch(_main);
-	}
+	int try_getc() const;
 
-	void set_keypad(bool bl) {
-		// Set keypad options
-		keypad(_main, bl);
-	}
+	// Read the rest of a bracketed paste, after key_paste_begin
+	// 	has been received (up to paste_limit bytes, or until the
+	// 	input runs out)
+	std::string read_paste() const;
+
+	int getc() const;
+
+	void set_keypad(bool bl);
 
 	void cursor(int y, int x) {
 		wmove(_main, y, x);
@@ -162,101 +641,64 @@ class BoxedWindow : public PlainWindow {
 protected:
         WINDOW *_box    = nullptr;
 	// WINDOW *_main	= nullptr;
+
+	// Erase and give back the border, if any
+	void _release_box();
 public:
 	// Default constructor
 	BoxedWindow() = default;
 
 	// Constructors
 	// TODO: clean up (duplicated code)
-	BoxedWindow(int height, int width, int y, int x)
-			: PlainWindow(height, width, y, x) {
-		// Create the windows
-		_box = newwin(height, width, y, x);
-		_main = newwin(height - 2, width - 2, y + 1, x + 1);
-
-		// Borders
-		box(_box, 0, 0);
+	BoxedWindow(int height, int width, int y, int x);
 
-		// Refresh all boxes
-		wrefresh(_box);
-	}
-
-	BoxedWindow(const ScreenInfo &i)
-			: PlainWindow(i) {
-		// Create the windows
-		_box = newwin(info.height, info.width, info.y, info.x);
-		_main = newwin(info.height - 2, info.width - 2, info.y + 1, info.x + 1);
+	BoxedWindow(const ScreenInfo &i);
 
-		// Borders
-		box(_box, 0, 0);
+	// Moving takes over the curses windows
+	BoxedWindow(BoxedWindow &&other) noexcept
+			: PlainWindow(std::move(other)),
+			_box(std::exchange(other._box, nullptr)) {}
 
-		// Refresh all boxes
-		wrefresh(_box);
-	}
+	BoxedWindow &operator=(BoxedWindow &&other) noexcept;
 
 	// Destructor
-	virtual ~BoxedWindow() {
-		// Delete the windows
-		werase(_box);
-		wrefresh(_box);
-		delwin(_box);
-	}
+	virtual ~BoxedWindow();
 };
 
 // Decorated Window (title, border, etc.)
 class DecoratedWindow : public BoxedWindow {
 protected:
         WINDOW *_title = nullptr;
-	const std::string _title_str;
+	std::string _title_str;
+
+	// Erase and give back the title, if any
+	void _release_title();
 public:
 	// Default constructor
 	DecoratedWindow() = default;
 
 	// Constructors
-	DecoratedWindow(const std::string &title, int height, int width, int y, int x)
-			: BoxedWindow(height, width, y, x), _title_str(title) {
-		// Create the windows
-		_main = newwin(height - 5, width - 2, y + 4, x + 1);
-		_title = newwin(3, width - 2, y + 1, x + 1);
-
-		// Borders
-		box(_title, 0, 0);
-
-		// Write title
-		int remaining = (width - 2) - title.length();
-		mvwprintw(_title, 1, remaining/2, "%s", title.c_str());
-
-		// Refresh all boxes
-		wrefresh(_title);
-	}
+	DecoratedWindow(const std::string &title, int height, int width, int y, int x);
 
 	DecoratedWindow(const std::string &title, const ScreenInfo &info)
 			: DecoratedWindow(title, info.height, info.width, info.y, info.x) {}
 
+	// Moving takes over the curses windows
+	DecoratedWindow(DecoratedWindow &&other) noexcept
+			: BoxedWindow(std::move(other)),
+			_title(std::exchange(other._title, nullptr)),
+			_title_str(std::move(other._title_str)) {}
+
+	DecoratedWindow &operator=(DecoratedWindow &&other) noexcept;
+
 	// Destructor
-	virtual ~DecoratedWindow() {
-		// Delete the windows
-		werase(_title);
-		wrefresh(_title);
-		delwin(_title);
-	}
+	virtual ~DecoratedWindow();
 
 	// Refreshing
-	virtual void refresh() const override {
-		BoxedWindow::refresh();
-		wrefresh(_title);
-	}
+	virtual void refresh() const override;
 
 	// Give title text an attribute
-	void attr_title(int attr) {
-		wattron(_title, attr);
-
-		int remaining = (info.width - 2) - _title_str.length();
-		mvwprintw(_title, 1, remaining/2, "%s", _title_str.c_str());
-
-		wattroff(_title, attr);
-		wrefresh(_title);
-	}
+	void attr_title(int attr);
 
 	// TODO: change title string (with option to autoresize)
 	// + resize function
@@ -283,62 +725,36 @@ public:
 		bool centered;
 		bool multi;
 	};
+
+	// Actions that keys can be bound to
+	enum class Action {
+		up,
+		down,
+		select,
+		cancel
+	};
+
+	using Keymap = std::unordered_map <int, Action>;
 protected:
 	Option		_option;
 	OptionList	_option_list;
 	int		_line = 0;
 	bool		_terminate = false;
 
-	// Handle key input
-	void _handle_key(int c, Selection &selected) {
-		// Arrow keys
-		if (c == KEY_UP)
-			_line--;
-
-		if (c == KEY_DOWN)
-			_line++;
-
-		// Allow overflow if multi
-		int size = _option_list.size();
-		if (_option.multi)
-			_line = std::max(0, std::min(_line, size));
-		else
-			_line = std::max(0, std::min(_line, size - 1));
-
-		// TODO: undo all selections if ESC is pressed
-		if (c == 27)
-			_terminate = true;
-
-		// Enter key to select
-		if (c == 10) {
-			if (!_option.multi) {
-				selected.insert(_line);
-				_terminate = true;
-			} else {
-				// Check if on the OK key
-				if (_line == size) {
-					_terminate = true;
-					return;
-				}
+	// Defaults are bound by the constructor
+	Keymap		_keymap;
 
-				if (selected.find(_line) == selected.end())
-					selected.insert(_line);
-				else
-					selected.erase(_line);
-			}
-		}
-	}
+	// Handle key input
+	void _handle_key(int c, Selection &selected);
 
-	// Print ok button
-	void _print_ok(bool highlight) {
-		if (highlight)
-			attribute_set(A_REVERSE);
+	// Print ok button (refreshed with the rest of the frame)
+	void _print_ok(bool highlight);
 
-		mvprintf(info.height - 6, info.width / 2 - 4, "[ OK ]");
+	// Steps of an interaction, shared by yield and the scheduler
+	void _begin();
+	void _draw(const Selection &selected);
 
-		if (highlight)
-			attribute_set(A_NORMAL);
-	}
+	friend class Scheduler;
 public:
 	// Default constructor
 	SelectionWindow() = default;
@@ -346,283 +762,913 @@ public:
 	// Constructors
 	SelectionWindow(const std::string &title, const ScreenInfo &info,
 			const OptionList &option_list,
-			const Option &option = Option {false, false})
-			: DecoratedWindow(title, info),
-			_option_list(option_list),
-			_option(option) {
-		// Preprocess the options list if centered
-		if (_option.centered) {
-			// Pad to the window width
-			int width = info.width - 4;
-			for (auto &str : _option_list) {
-				int len = str.length();
-				int pad_left = (width - len) / 2;
-				int pad_right = width - len - pad_left;
-
-				str.insert(0, pad_left, ' ');
-				str.append(pad_right, ' ');
-			}
-		}
-	}
+			const Option &option = Option {false, false});
 
 	// Yield selected options
-	bool yield(Selection &selected) {
-		// TODO: ok button if multiselect
-
-		// No echo, no cursor
-		noecho();
-		curs_set(0);
-
-		// Keyboard
-		// TODO: method
-		keypad(_main, true);
-
-		// Loop
-		while (!_terminate) {
-			// Reprint all options
-			for (int i = 0; i < _option_list.size(); i++) {
-				// Hghlight if selected or hovering
-				if (selected.count(i) || i == _line)
-					attribute_on(A_REVERSE);
-				mvprintf(i, 1, "%s", _option_list[i].c_str());
-				attribute_set(A_NORMAL);
-			}
+	bool yield(Selection &selected);
 
-			// Print ok button if multiselect
-			if (_option.multi)
-				_print_ok(_line == _option_list.size());
+	// Bind a key to an action (replacing its previous binding)
+	void bind(int key, Action action);
 
-			// Key handling
-			_handle_key(getc(), selected);
-
-			// Refresh
-			refresh();
-		}
+	// Remove the binding of a key
+	void unbind(int key);
 
-		return selected.size() > 0;
+	// Key bindings
+	Keymap &keymap() {
+		return _keymap;
 	}
 };
 
-// Display a table on a window
-template <class T>
-class Table : public PlainWindow {
+// Tree of lazily loaded nodes: children are only fetched when a
+// 	node is expanded, and only the rows in view are drawn
+class TreeView : public DecoratedWindow {
 public:
-	// Aliases
-	using Headers = std::vector <std::string>;
-	using Data = std::vector <T>;
-	using Generator = std::function <std::string (const T &, size_t)>;
-	using Lengths = std::vector <size_t>;
+	// Child of a node, as returned by the fetch callback
+	struct Entry {
+		std::string	label;
+		bool		leaf;
+	};
 
-	// Update structure
-	struct From {
-		Headers		headers;
-		Data		data;
-		Generator	generator;
-		Lengths		lengths;
+	// Aliases
+	using Entries = std::vector <Entry>;
+	using Path = std::vector <std::string>;
+	using Fetch = std::function <Entries (const Path &)>;
 
-		bool		auto_resize = false;
+	// Options for this window
+	struct Option {
+		// Collapsed subtrees are evicted beyond this many loaded
+		// 	nodes (0 for no limit)
+		size_t max_nodes = 0;
+	};
 
-		// Constructor from headers and generator
-		From(const Headers &headers, Generator generator)
-				: headers(headers), generator(generator) {}
+	// Actions that keys can be bound to
+	enum class Action {
+		up,
+		down,
+		page_up,
+		page_down,
+		expand,
+		collapse,
+		toggle,
+		select,
+		cancel
 	};
+
+	using Keymap = std::unordered_map <int, Action>;
 protected:
-	Headers _headers;
-	Data _data;
-	Lengths _lengths;
+	struct Node {
+		std::string				label;
+		bool					leaf;
+		int					depth;
+		Node					*parent;
+
+		bool					loaded = false;
+		bool					expanded = false;
+		std::vector <std::unique_ptr <Node>>	children;
+	};
 
-	// TODO: array of lengths for each column (either auto or specified)
+	Fetch _fetch;
+	Option _option;
 
-	// Function to generate columns from data
-	Generator _generator;
+	// Top level nodes (the children of the empty path)
+	std::vector <std::unique_ptr <Node>> _roots;
 
-	// Get lengths for each column
-	void _get_lengths() {
-		_lengths = Lengths(_headers.size(), 0);
-
-		for (size_t i = 0; i < _headers.size(); i++) {
-			_lengths[i] = _headers[i].length();
-			for (const auto &d : _data) {
-				size_t l = _generator(d, i).length();
-				if (l > _lengths[i])
-					_lengths[i] = l;
-			}
-		}
-	}
+	// Flattened visible rows, in display order
+	std::vector <Node *> _rows;
 
-	// Write table
-	void _write_table(int highlight = -1) const {
-		// Variables
-		int x = 0;
-		int line = 0;
+	size_t _line = 0;
+	size_t _offset = 0;
+	size_t _loaded = 0;
 
-		// Write top bar
-		x = 0;
+	bool _terminate = false;
+	bool _selected = false;
 
-		mvadd_char(line, 0, ACS_ULCORNER);
-		for (size_t i = 0; i < _headers.size(); i++) {
-			for (int j = 0; j < _lengths[i] + 2; j++)
-				mvadd_char(line, x + j + 1, ACS_HLINE);
-			x += _lengths[i] + 3;
+	// Defaults are bound by the constructor
+	Keymap _keymap;
 
-			if (i != _headers.size() - 1)
-				mvadd_char(line, x, ACS_TTEE);
-			else
-				mvadd_char(line, x, ACS_URCORNER);
-		}
-		line++;
-
-		// Write headers
-		x = 1;
-		for (size_t i = 0; i < _headers.size(); i++) {
-			mvprintf(line, x, " %s ", _headers[i].c_str());
-			x += _lengths[i] + 3;
-			mvadd_char(line, x - 1, ACS_VLINE);
-		}
-		mvadd_char(line, 0, ACS_VLINE);
-		line++;
-
-		// Write middle bar
-		x = 0;
-
-		mvadd_char(line, 0, ACS_LTEE);
-		for (size_t i = 0; i < _headers.size(); i++) {
-			for (int j = 0; j < _lengths[i] + 2; j++)
-				mvadd_char(line, x + j + 1, ACS_HLINE);
-			x += _lengths[i] + 3;
-
-			if (i != _headers.size() - 1)
-				mvadd_char(line, x, ACS_PLUS);
-			else
-				mvadd_char(line, x, ACS_RTEE);
-		}
-		line++;
+	// Visible rows
+	size_t _page() const {
+		return std::max(1, info.height - decoration_height);
+	}
 
-		// Write data
-		for (size_t n = 0; n < _data.size(); n++) {
-			x = 1;
+	// Path from the top level to a node
+	static Path _path(const Node *node);
 
-			T d = _data[n];
-			for (size_t i = 0; i < _headers.size(); i++) {
-				std::string str = _generator(d, i);
+	// Fetch the children of a node (or the top level if null)
+	std::vector <std::unique_ptr <Node>> _load(Node *parent);
 
-				// Pad string with spaces
-				str = str.substr(0, _lengths[i]);
-				if (str.length() < _lengths[i])
-					str.append(std::string(_lengths[i] - str.length(), ' '));
+	// Number of loaded nodes in a subtree (excluding its root)
+	static size_t _count(const Node *node);
 
-				// Highlight if needed
-				if (n == highlight)
-					wattrset(_main, A_REVERSE);
+	// Append the visible descendants of a node
+	static void _collect(Node *node, std::vector <Node *> &rows);
 
-				mvprintf(line, x, " %s ", str.c_str());
+	// Free collapsed subtrees until within the node budget
+	void _evict(Node *node);
 
-				if (n == highlight)
-					wattrset(_main, A_NORMAL);
+	void _evict();
 
-				// Normal
-				x += _lengths[i] + 3;
-				mvadd_char(line, x - 1, ACS_VLINE);
-			}
-			mvadd_char(line, 0, ACS_VLINE);
-			line++;
-		}
+	// Expand the node on a row, inserting its visible rows
+	void _expand(size_t row);
 
-		// Write the bottom bar
-		x = 0;
+	// Collapse the node on a row, removing its visible rows
+	void _collapse(size_t row);
 
-		mvadd_char(line, 0, ACS_LLCORNER);
-		for (size_t i = 0; i < _headers.size(); i++) {
-			for (int j = 0; j < _lengths[i] + 2; j++)
-				mvadd_char(line, x + j + 1, ACS_HLINE);
-			x += _lengths[i] + 3;
+	// Keep the current line in view
+	void _scroll();
 
-			if (i != _headers.size() - 1)
-				mvadd_char(line, x, ACS_BTEE);
-			else
-				mvadd_char(line, x, ACS_LRCORNER);
-		}
-		line++;
-	}
+	// Handle key input
+	void _handle_key(int c);
+
+	// Write the rows in view
+	void _write_rows() const;
+
+	// Write and paint the rows in view
+	void _draw() const;
 public:
 	// Default constructor
-	Table() = default;
+	TreeView() = default;
 
 	// Constructors
-	// TODO: auto resize window
-	Table(const From &from, int height, int width, int y, int x)
-			: PlainWindow(height, width, y, x),
-			_headers(from.headers), _data(from.data),
-			_generator(from.generator), _lengths(from.lengths) {
-		// Get lengths (auto)
-		if (_lengths.empty())
-			_get_lengths();
-
-		// Resize window if requested
-		if (from.auto_resize) {
-			int new_height = _data.size() + 4;
-			int new_width = 1;
-			for (const auto &l : _lengths)
-				new_width += l + 3;
-			resize(new_height, new_width);
-		}
+	TreeView(const std::string &title, const ScreenInfo &info,
+			const Fetch &fetch, const Option &option);
 
-		// Write table
-		_write_table();
+	TreeView(const std::string &title, const ScreenInfo &info,
+			const Fetch &fetch)
+			: TreeView(title, info, fetch, Option {}) {}
 
-		// Refresh all boxes
-		wrefresh(_main);
-	}
+	// Browse the tree, true if a node was selected (its path
+	// 	is stored in selected)
+	bool yield(Path &selected);
 
-	Table(const From &from, const ScreenInfo &info)
-			: Table(from,
-				info.height, info.width,
-				info.y, info.x
-			) {}
+	// Bind a key to an action (replacing its previous binding)
+	void bind(int key, Action action);
 
-	// Update data
-	void set_data(const Data &data, bool auto_resize = false) {
-		// First, erase
-		erase();
+	// Remove the binding of a key
+	void unbind(int key);
 
-		_data = data;
+	// Key bindings
+	Keymap &keymap() {
+		return _keymap;
+	}
 
-		if (auto_resize) {
-			_lengths.clear();
-			_get_lengths();
-			resize(_data.size() + 4, 1);
-		}
+	// Number of visible rows and loaded nodes
+	size_t rows() const {
+		return _rows.size();
+	}
 
-		_write_table();
-		wrefresh(_main);
+	size_t loaded() const {
+		return _loaded;
 	}
+};
 
-	// Update lengths
-	void set_lengths(const Lengths &lengths) {
-		// First, erase
-		erase();
+// Incremental reader of delimited text (CSV, TSV...) from a file
+// 	descriptor: records are split as the bytes come in, with
+// 	memchr scanning for line ends and delimiters, and a partial
+// 	record is kept until the rest of it arrives
+class DelimitedReader {
+public:
+	// Fields of a record
+	using Record = std::vector <std::string>;
+
+	// Options for the reader
+	struct Option {
+		char	delimiter = ',';
+
+		// Whether fields can be quoted (with "" for quotes),
+		// 	spanning delimiters and lines
+		bool	quotes = true;
+
+		// Bytes read at a time, and reads per call to read
+		size_t	chunk = 1 << 16;
+		int	reads = 4;
+	};
+private:
+	int		_fd = -1;
+	Option		_opt;
+
+	// Bytes read, the ones before _start are already split
+	std::string	_buffer;
+	size_t		_start = 0;
+
+	bool		_eof = false;
+
+	// Split a record without quotes
+	void _split(const char *begin, const char *end, Record &record) const;
+
+	// Split a record with quoted fields, returns the bytes used
+	// 	(0 if the record is incomplete, unless at the end)
+	size_t _split_quoted(const char *begin, const char *end, Record &record, bool last) const;
+
+	// Split all the complete records in the buffer
+	void _scan(std::vector <Record> &records);
+public:
+	// Constructors, the descriptor is not owned by the reader
+	DelimitedReader(int fd) : _fd(fd) {}
+	DelimitedReader(int fd, const Option &opt) : _fd(fd), _opt(opt) {}
+
+	// Append the complete records available, without blocking;
+	// 	returns false once the input has ended (the last records
+	// 	come with that call)
+	bool read(std::vector <Record> &records);
+
+	// Wait for input, returns true if there is some
+	bool wait(int timeout) const;
+
+	int fd() const {
+		return _fd;
+	}
+
+	bool eof() const {
+		return _eof;
+	}
+};
+
+// Display a table on a window; the members are defined in
+// 	tuicpp_inl.hpp and only compiled into the library for int,
+// 	float, double and std::string, any other T needs that header
+// 	included (undefined references to Table <T> otherwise)
+template <class T>
+class Table : public PlainWindow {
+public:
+	// Aliases
+	using Headers = std::vector <std::string>;
+	using Data = std::vector <T>;
+	using Generator = std::function <std::string (const T &, size_t)>;
+	using Lengths = std::vector <size_t>;
+	using Predicate = std::function <bool (const T &)>;
+	using Parser = std::function <T (const DelimitedReader::Record &)>;
+
+	// Update structure
+	struct From {
+		Headers		headers;
+		Data		data;
+		Generator	generator;
+		Lengths		lengths;
+
+		bool		auto_resize = false;
+
+		// Constructor from headers and generator
+		From(const Headers &headers, Generator generator)
+				: headers(headers), generator(generator) {}
+	};
+
+	// Conditional formatting: cells of rows satisfying the
+	// 	predicate get the attributes (in one column, or the whole
+	// 	row if the column is negative)
+	struct Rule {
+		int		column;
+		Predicate	predicate;
+		attr_t		attr;
+	};
+
+	// Style sheet, attributes can include color pairs
+	struct Style {
+		// Attributes of the headers and of each column
+		attr_t			header = A_NORMAL;
+		std::vector <attr_t>	columns;
+
+		// Attributes of every other row shown
+		attr_t			stripe = A_NORMAL;
+
+		// Rules are combined in order
+		std::vector <Rule>	rules;
+	};
+protected:
+	Headers _headers;
+	Data _data;
+	Lengths _lengths;
+
+	// TODO: array of lengths for each column (either auto or specified)
+
+	// Function to generate columns from data
+	Generator _generator;
 
-		_lengths = lengths;
-		_write_table();
-		wrefresh(_main);
+	// Whether the lengths are measured from the data
+	bool _auto_lengths = true;
+
+	// View state: leading columns pinned to the left, the first
+	// 	scrolled column after them and the first row shown
+	size_t _frozen = 0;
+	size_t _column_offset = 0;
+	size_t _row_offset = 0;
+
+	// Highlighted row (among the rows shown), -1 for none
+	int _highlight = -1;
+
+	// Style sheet, evaluated into the attributes of each cell
+	// 	(row major, by data index) whenever the data changes
+	Style _style;
+	std::vector <attr_t> _attrs;
+
+	bool _styled() const {
+		return !_style.columns.empty() || !_style.rules.empty();
 	}
 
+	// Add attributes, a color pair replaces the one before it
+	// 	(pairs can't be combined bitwise)
+	static attr_t _combine(attr_t attr, attr_t add);
+
+	// Evaluate the style of a row
+	void _style_row(size_t index);
+
+	// Evaluate the style of every row
+	void _restyle();
+
+	// Attributes of a cell, given its position among the rows shown
+	attr_t _cell_attr(size_t index, size_t column, size_t n) const;
+
+	// Cached sort key of a cell
+	struct Key {
+		std::string	str;
+		double		num;
+		bool		numeric;
+	};
+
+	// Display order of the rows, as indices into the data
+	std::vector <size_t> _order;
+
+	// Sort state, keys are only extracted for the sort column
+	int _sort_column = -1;
+	bool _ascending = true;
+	std::vector <Key> _keys;
+
+	// Minimum number of rows to sort in parallel
+	static constexpr size_t parallel_threshold = 1 << 15;
+
+	// Make a key from a cell, numbers are compared as numbers
+	static Key _make_key(const std::string &str);
+
+	// Whether row a goes before row b, ties are broken by
+	// 	index so that the order is always stable
+	bool _before(size_t a, size_t b) const;
+
+	// Extract the keys of the sort column
+	void _get_keys();
+
+	// Sort the order (in parallel for large tables)
+	void _sort_order();
+
+	// Reset the order, sorting it if needed
+	void _reorder();
+
+	// Position of a row within the order (with its current key)
+	std::vector <size_t> ::iterator _find(size_t index);
+
+	// Grow the lengths to fit a row
+	void _fit_row(size_t index);
+
+	// Filter state: a row is shown if it satisfies the predicate
+	// 	and one of its cells contains the query
+	Predicate _predicate;
+	std::string _query;
+
+	// Formatted text of each row (cells separated by newlines),
+	// 	only built once there is a query
+	std::vector <std::string> _text;
+
+	// Match flags for every row, and the matching rows in
+	// 	data order
+	std::vector <char> _shown;
+	std::vector <size_t> _matches;
+
+	// Matching rows in display order (only kept while filtered,
+	// 	the order itself is used otherwise)
+	std::vector <size_t> _visible;
+
+	bool _filtered() const {
+		return _predicate || !_query.empty();
+	}
+
+	// Formatted text of a row
+	std::string _row_text(size_t index) const;
+
+	// Check a row against the filter
+	bool _match(size_t index);
+
+	// Rebuild the match index, only rechecking the current
+	// 	matches if the filter got narrower
+	void _rescan(bool narrower = false);
+
+	// Recheck a single (changed or appended) row
+	void _rescan_row(size_t index);
+
+	// Rebuild the display order of the matching rows
+	void _index_visible();
+
+	// Position of a matching row within the display order
+	std::vector <size_t> ::iterator _find_visible(size_t index);
+
+	// Index into the data of the nth row shown
+	size_t _shown_row(size_t row) const {
+		return _filtered() ? _visible[row] : _order[row];
+	}
+
+	// Rows changed wholesale, so does the match index
+	void _reset_filter();
+
+	// Streaming state: rows appended since the last paint, and
+	// 	when that was
+	bool _stale = false;
+	std::chrono::steady_clock::time_point _painted;
+
+	// Add a row at its sorted position, without drawing
+	void _push(const T &value);
+
+	// Rewrite the whole table
+	void _redraw();
+
+	// Get lengths for each column
+	void _get_lengths();
+
+	// Columns in view, as the column and the width it is drawn
+	// 	with: the frozen columns, then the scrolled ones which fit
+	// 	(the last one may be cut off)
+	std::vector <std::pair <size_t, size_t>> _view_columns(int width) const;
+
+	// Body rows which fit in the window
+	size_t _view_rows() const;
+
+	// Write a horizontal bar across the columns in view
+	void _write_bar(int line, const std::vector <std::pair <size_t, size_t>> &columns,
+			chtype left, chtype middle, chtype right) const;
+
+	// Write the table in view: the header stays in place while the
+	// 	body scrolls, and only the cells in view are formatted
+	void _write_table() const;
+public:
+	// Default constructor
+	Table() = default;
+
+	// Constructors
+	// TODO: auto resize window
+	Table(const From &from, int height, int width, int y, int x);
+
+	Table(const From &from, const ScreenInfo &info)
+			: Table(from,
+				info.height, info.width,
+				info.y, info.x
+			) {}
+
+	// Update data
+	void set_data(const Data &data, bool auto_resize = false);
+
+	// Update lengths
+	void set_lengths(const Lengths &lengths);
+
 	// Set the generator
-	void set_generator(const Generator &generator) {
-		// First, erase
-		erase();
+	void set_generator(const Generator &generator);
+
+	// Set the style sheet, evaluating it for every row
+	void set_style(const Style &style);
+
+	const Style &style() const {
+		return _style;
+	}
+
+	// Highlight a row, scrolling it into view
+	void highlight_row(int row);
+
+	// Pin the first columns to the left while scrolling
+	void freeze_columns(size_t columns);
+
+	// Scroll the unfrozen columns horizontally
+	void scroll_columns(int delta);
+
+	// Scroll the body vertically, the header stays in place
+	void scroll_rows(int delta);
+
+	// Key driven scrolling with the arrow and page keys; returns
+	// 	true if the key was handled
+	bool scroll_key(int c);
+
+	// Sort the rows by a column, without moving the data
+	void sort_by(size_t column, bool ascending = true);
+
+	// Go back to the order of the data
+	void unsort();
+
+	// Key driven sorting: digits pick the column to sort by (0 to
+	// 	unsort), and picking the same column again flips the
+	// 	direction; returns true if the key was handled
+	bool sort_key(int c);
+
+	// Update a single row, moving it to its sorted position
+	void set_row(size_t index, const T &value);
+
+	// Append a row, inserting it at its sorted position
+	void append(const T &value);
+
+	// Append rows in one go, redrawing once
+	void append_rows(const Data &rows);
+
+	// Append the rows available from a reader, repainting at most
+	// 	once per period (the view follows new rows if it was at
+	// 	the bottom); returns false once the input has ended
+	bool ingest(DelimitedReader &reader, const Parser &parse,
+			std::chrono::milliseconds period = std::chrono::milliseconds(50));
+
+	// Read a reader to its end, waiting for input in between and
+	// 	repainting at most once per period
+	void ingest_all(DelimitedReader &reader, const Parser &parse,
+			std::chrono::milliseconds period = std::chrono::milliseconds(50));
+
+	// Only show rows satisfying a predicate
+	void filter(const Predicate &predicate);
+
+	// Only show rows with a cell containing the query; extending
+	// 	the previous query only rechecks its matches
+	void search(const std::string &query);
+
+	// Show all rows again
+	void clear_filter();
+
+	// Number of rows shown
+	size_t visible() const {
+		return _filtered() ? _matches.size() : _data.size();
+	}
+
+	// Index into the data of a shown row (e.g. the one passed
+	// 	to highlight_row), or -1 if there is no such row
+	long data_index(size_t row) const;
+
+	// View state
+	size_t frozen_columns() const {
+		return _frozen;
+	}
+
+	size_t column_offset() const {
+		return _column_offset;
+	}
+
+	size_t row_offset() const {
+		return _row_offset;
+	}
+
+	// Sort state
+	int sort_column() const {
+		return _sort_column;
+	}
+
+	bool ascending() const {
+		return _ascending;
+	}
+};
+
+// Table of numeric columns, stored as contiguous arrays; column
+// 	widths come from the range of each column and only the rows
+// 	that fit in the window are formatted (float and double are
+// 	compiled into the library, other types need tuicpp_inl.hpp)
+template <class T>
+class NumericTable : public PlainWindow {
+	static_assert(std::is_arithmetic <T> ::value,
+		"NumericTable requires an arithmetic type");
+public:
+	// Column of numbers and its format
+	struct Column {
+		std::string		header;
+		std::vector <T>		data {};
+
+		// Digits after the point, ignored for integers
+		int			precision = 6;
+	};
+
+	// Aliases
+	using Columns = std::vector <Column>;
+	using Lengths = std::vector <size_t>;
+protected:
+	// Range of a column
+	struct Range {
+		T lo;
+		T hi;
+	};
+
+	Columns			_columns;
+	std::vector <Range>	_ranges;
+	Lengths			_lengths;
+
+	size_t			_rows = 0;
+	size_t			_offset = 0;
+	long			_highlight = -1;
+
+	// Formatting buffer for a single cell
+	mutable std::vector <char> _cell;
+
+	// Reduce a column to its range, accumulating into independent
+	// 	lanes so that the loop vectorizes
+	static Range _reduce(const T *data, size_t n);
+
+	// Format a value into the cell buffer, returns its length
+	int _format(T v, int precision, int width = 0) const;
+
+	// Measure a column: formatted length is monotonic in the
+	// 	magnitude, so only the extremes need formatting
+	void _measure(size_t i);
+
+	// Measure all columns
+	void _measure();
+
+	// Number of rows that fit in the window
+	size_t _page() const {
+		return std::max(0, info.height - 4);
+	}
+
+	size_t _max_offset() const {
+		return (_rows > _page()) ? _rows - _page() : 0;
+	}
+
+	// Horizontal bar with the given junctions
+	void _write_bar(int line, chtype left, chtype middle, chtype right) const;
+
+	// Write the visible part of the table
+	void _write_table() const;
+
+	// Write and paint the visible part of the table
+	void _redraw() const;
+public:
+	// Default constructor
+	NumericTable() = default;
+
+	// Constructors
+	NumericTable(const Columns &columns, const ScreenInfo &info);
+
+	// Replace all columns
+	void set_columns(const Columns &columns);
+
+	// Replace the data of a single column
+	void set_column(size_t i, const std::vector <T> &data);
+
+	// Append a row (one value per column), growing the
+	// 	ranges without rescanning the columns
+	void append(const std::vector <T> &row);
+
+	// Scroll the rows in view
+	void scroll_rows(long lines);
+
+	// Highlight a specific row (index into the columns), or
+	// 	none if negative
+	void highlight_row(long row);
+
+	// Getters
+	size_t rows() const {
+		return _rows;
+	}
+
+	size_t offset() const {
+		return _offset;
+	}
+
+	const Lengths &lengths() const {
+		return _lengths;
+	}
+};
+
+// Real time chart of a stream of samples
+class Chart : public PlainWindow {
+public:
+	// How samples are reduced into a column
+	enum class Mode {
+		min_max,	// Envelope of each column
+		average		// Bars of the column averages
+	};
+
+	// Options for this window
+	struct Option {
+		size_t	capacity = 0;		// 0 keeps just enough to fill the window
+		size_t	per_column = 1;		// Fewest samples reduced into a column
+		Mode	mode = Mode::min_max;
+		bool	braille = true;		// Two columns of dots per cell (wide ncurses only)
+
+		// Fixed range, automatic if lo >= hi
+		float	lo = 0;
+		float	hi = 0;
+	};
+protected:
+	// Reduction of a range of samples
+	struct Bucket {
+		float	lo;
+		float	hi;
+		double	sum;
+		size_t	n;
+	};
+
+	Option _option;
+
+	// Ring buffer of samples
+	std::vector <float> _ring;
+	size_t _count = 0;
+
+	// Buckets shown in the window (oldest first), the absolute
+	// 	index of the first one and the samples in each
+	std::vector <Bucket> _buckets;
+	size_t _first = 0;
+	size_t _per = 1;
+
+	// Current vertical range
+	float _lo = 0;
+	float _hi = 0;
+
+	// Reduce contiguous samples, accumulating into independent
+	// 	lanes so that the loop vectorizes without fast-math
+	static Bucket _reduce(const float *data, size_t n);
+
+	// Reduce samples [begin, end) (absolute indices) of the ring
+	Bucket _reduce_range(size_t begin, size_t end) const;
+
+	// Number of buckets across the window
+	size_t _columns() const {
+		return info.width * (_option.braille ? 2 : 1);
+	}
+
+	// Samples still in the ring
+	size_t _retained() const {
+		return std::min(_count, _ring.size());
+	}
+
+	// Samples per bucket so that the retained samples fit in the
+	// 	window, but never fewer than per_column
+	size_t _bucket_size() const;
+
+	// Recompute all visible buckets from the ring
+	void _rebuild();
+
+	// Fit the range to the visible buckets, true if it changed
+	bool _fit_range();
+
+	// Quarter-cell level of a value, from the bottom of the window
+	int _level(float v) const;
+
+	// Levels covered by a bucket, as a bar or as an envelope
+	std::pair <int, int> _span(const Bucket &b) const;
+
+	// Scan line glyph for a quarter-cell level
+	static chtype _glyph(int level);
+
+	// Draw the cell column holding bucket c (without refreshing)
+	void _draw_column(size_t c) const;
+
+	// Draw cell column x from the pair of buckets it holds
+	void _draw_braille(int x) const;
+
+	// Draw all columns
+	void _draw() const;
+public:
+	// Default constructor
+	Chart() = default;
+
+	// Constructors
+	Chart(const ScreenInfo &info, const Option &option);
+
+	Chart(const ScreenInfo &info)
+			: Chart(info, Option {}) {}
+
+	// Append a sample, only redrawing the affected column unless
+	// 	the chart scrolls or its range changes
+	void push(float v);
+
+	// Append many samples, reducing the visible range once
+	void push(const float *data, size_t n);
+
+	void push(const std::vector <float> &data) {
+		push(data.data(), data.size());
+	}
+
+	// Set a fixed range (or automatic if lo >= hi)
+	void set_range(float lo, float hi);
+
+	// Remove all samples
+	void reset();
+
+	// Total number of samples pushed
+	size_t samples() const {
+		return _count;
+	}
+};
+
+// Board of progress bars for many concurrent tasks; workers bump
+// 	the task counters without locking, and the board samples
+// 	them at a fixed rate from the UI thread
+class ProgressBoard : public DecoratedWindow {
+public:
+	// Progress of a single task
+	class Task {
+		std::string		_label;
+		std::atomic <size_t>	_done {0};
+		std::atomic <size_t>	_total;
+
+		// Last drawn state, only touched by the UI thread
+		int			_filled = -1;
+		int			_percent = -1;
+
+		friend class ProgressBoard;
+	public:
+		// Constructor
+		Task(const std::string &label, size_t total)
+				: _label(label), _total(total) {}
+
+		// Worker side (thread safe)
+		void advance(size_t n = 1) {
+			_done.fetch_add(n, std::memory_order_relaxed);
+		}
+
+		void set(size_t done) {
+			_done.store(done, std::memory_order_relaxed);
+		}
+
+		void set_total(size_t total) {
+			_total.store(total, std::memory_order_relaxed);
+		}
 
-		_generator = generator;
-		_write_table();
-		wrefresh(_main);
+		// Getters
+		size_t done() const {
+			return _done.load(std::memory_order_relaxed);
+		}
+
+		size_t total() const {
+			return _total.load(std::memory_order_relaxed);
+		}
+
+		bool finished() const {
+			return done() >= total();
+		}
+	};
+protected:
+	// Deque so that tasks never move once handed out
+	std::deque <Task>	_tasks;
+	size_t			_label_width = 0;
+	int			_offset = 0;
+
+	// Visible rows
+	int _rows() const {
+		return info.height - decoration_height;
 	}
 
-	// Highlight a row
-	void highlight_row(int row) {
-		// First, erase
-		erase();
-		_write_table(row);
-		wrefresh(_main);
+	// Width of the bar itself
+	int _bar_width() const;
+
+	// Forget what was drawn, forcing a full repaint
+	void _invalidate();
+
+	// Draw a task on its row if its bar changed, true if drawn
+	bool _draw_task(Task &task, int line);
+public:
+	// Default constructor
+	ProgressBoard() = default;
+
+	// Constructors
+	ProgressBoard(const std::string &title, const ScreenInfo &info)
+			: DecoratedWindow(title, info) {}
+
+	// Add a task, only from the UI thread; the reference
+	// 	stays valid for the lifetime of the board
+	Task &add(const std::string &label, size_t total);
+
+	// Scroll the visible tasks
+	void scroll_tasks(int lines);
+
+	// Repaint changed bars, true if all tasks are finished
+	bool sample();
+
+	// Sample at a fixed rate until all tasks are finished
+	void run(std::chrono::milliseconds period = std::chrono::milliseconds(50));
+
+	// Number of tasks
+	size_t size() const {
+		return _tasks.size();
+	}
+};
+
+// Sorted index of completion candidates, built once and shared
+// 	between fields (and editors); candidates matching a prefix are
+// 	a contiguous range of it
+class Completions {
+public:
+	// Range of candidates, [first, last)
+	using Range = std::pair <size_t, size_t>;
+private:
+	std::vector <std::string> _words;
+public:
+	// Sorts the candidates, dropping duplicates
+	Completions(std::vector <std::string> words);
+
+	// Candidates starting with prefix
+	Range range(const std::string &prefix) const;
+
+	// Narrow the range of a prefix of length depth down to the
+	// 	candidates that continue it with byte
+	Range narrow(Range range, size_t depth, unsigned char byte) const;
+
+	const std::string &operator[](size_t i) const {
+		return _words[i];
+	}
+
+	size_t size() const {
+		return _words.size();
+	}
+
+	// Shared between yielders
+	static std::shared_ptr <const Completions> make(std::vector <std::string> words) {
+		return std::make_shared <const Completions> (std::move(words));
 	}
 };
 
@@ -638,9 +1684,18 @@ struct base_yielder {
 		return Ret::RET_NOP;
 	}
 
+	// Insert a block of text, one character at a time unless
+	// 	the yielder knows better
+	virtual Ret paste(const std::string &text);
+
 	virtual std::string content() {
 		return "";
 	}
+
+	// Rest of the suggested completion of the content, if any
+	virtual std::string suggestion() {
+		return "";
+	}
 };
 
 template <class T>
@@ -657,27 +1712,29 @@ template <>
 struct Tyielder <std::string> : public base_yielder {
 	std::string *value;
 
-	Tyielder(std::string *ptr) : value(ptr) {}
+	// Optional completions, and the range matching each prefix of
+	// 	the value, so that typing a byte narrows the last range
+	// 	and deleting one pops it
+	std::shared_ptr <const Completions> completions;
+	std::vector <Completions::Range> ranges;
 
-	Ret proc(int ch) override {
-		if (ch == KEY_BACKSPACE) {
-			if (!value->empty()) {
-				value->pop_back();
-				return Ret::RET_DEL;
-			}
+	Tyielder(std::string *ptr, std::shared_ptr <const Completions> completions = nullptr)
+			: value(ptr), completions(std::move(completions)) {}
 
-			return Ret::RET_NOP;
-		} else if (std::isprint(ch)) {
-			*value += ch;
-			return Ret::RET_PLUS;
-		}
+	// Right arrow accepts the suggestion
+	Ret proc(int ch) override;
 
-		return Ret::RET_NOP;
-	}
+	// Append the whole block at once, dropping control characters
+	Ret paste(const std::string &text) override;
 
 	std::string content() override {
 		return *value;
 	}
+
+	std::string suggestion() override;
+private:
+	// Bring the ranges in line with the value
+	void _sync();
 };
 
 // Factory for Yielder
@@ -688,88 +1745,214 @@ inline Yielder yielder(T *value)
 		(new Tyielder <T> {value});
 }
 
+// String fields with completions
+inline Yielder yielder(std::string *value, std::shared_ptr <const Completions> completions)
+{
+	return std::shared_ptr <base_yielder>
+		(new Tyielder <std::string> {value, std::move(completions)});
+}
+
+// Fuzzy finder over a list of candidates: a query line and a ranked
+// 	list of matches, scored on all cores in the background so that
+// 	results stream in while typing
+class FuzzyFinder : public DecoratedWindow {
+public:
+	// Aliases
+	using Candidates = std::vector <std::string>;
+
+	// Actions that keys can be bound to
+	enum class Action {
+		up,
+		down,
+		select,
+		cancel
+	};
+
+	using Keymap = std::unordered_map <int, Action>;
+protected:
+	// Scored candidate
+	struct Match {
+		int	score;
+		size_t	index;
+	};
+
+	// Scoring of one query, shared with the workers
+	struct Job {
+		std::string				query;
+		unsigned				generation;
+
+		// Candidates to score, all of them if null
+		std::shared_ptr <const std::vector <size_t>>	base;
+
+		std::atomic <size_t>			cursor {0};
+		std::atomic <int>			active {0};
+	};
+
+	// Candidates scored by a worker at a time
+	static constexpr size_t chunk = 4096;
+
+	// Candidates and the workers scoring them, which live as long
+	// 	as the finder and wait for jobs in between (kept on the
+	// 	heap so that the finder stays movable)
+	struct Search;
+
+	std::unique_ptr <Search>	_search;
+
+	// Owned by the UI thread
+	std::shared_ptr <Job>		_job;
+	std::vector <Match>		_results;
+	size_t				_ranked = 0;
+
+	std::string			_query;
+	size_t				_line = 0;
+	size_t				_offset = 0;
+
+	bool				_terminate = false;
+	bool				_selected = false;
+
+	// Defaults are bound by the constructor
+	Keymap _keymap;
+
+	// Fuzzy score of a candidate, negative if the query is not a
+	// 	(case insensitive) subsequence of it
+	static int _score(const std::string &query, const std::string &candidate);
+
+	// Ranking order: best score first, then candidate order
+	static bool _better(const Match &a, const Match &b);
+
+	// Start scoring the current query
+	void _start();
+
+	// Whether results are still coming in
+	bool _searching();
+
+	// Visible results
+	size_t _page() const {
+		return std::max(1, info.height - decoration_height - 2);
+	}
+
+	// Take in the pending results and rank the ones in view
+	void _collect();
+
+	// Handle key input
+	void _handle_key(int c);
+
+	// Draw the query and the results in view
+	void _draw(bool searching);
+public:
+	// Default constructor
+	FuzzyFinder() = default;
+
+	// Constructors
+	FuzzyFinder(const std::string &title, const ScreenInfo &info,
+			const Candidates &candidates);
+
+	// The search moves along with the finder
+	FuzzyFinder(FuzzyFinder &&);
+	FuzzyFinder &operator=(FuzzyFinder &&);
+
+	// Destructor, stops the workers
+	~FuzzyFinder();
+
+	// Pick a candidate, true if one was selected (its index
+	// 	is stored in index)
+	bool yield(size_t &index);
+
+	// Bind a key to an action (replacing its previous binding)
+	void bind(int key, Action action);
+
+	// Remove the binding of a key
+	void unbind(int key);
+
+	// Key bindings
+	Keymap &keymap() {
+		return _keymap;
+	}
+};
+
 // Field editor window
 class FieldEditor : public DecoratedWindow {
 public:
 	// Aliases
 	using Fields = std::vector <std::string>;
+
+	// Actions that keys can be bound to
+	enum class Action {
+		up,
+		down,
+		next,
+		confirm,
+		cancel
+	};
+
+	using Keymap = std::unordered_map <int, Action>;
+
+	// Field validators return an error message (empty if the value
+	// 	is fine); they run on a worker thread and can poll whether
+	// 	the value has changed since, to give up early
+	using Cancelled = std::function <bool ()>;
+	using Validator = std::function <std::string (const std::string &, const Cancelled &)>;
 protected:
+	using Clock = std::chrono::steady_clock;
+
+	// State of the validators, shared with their worker (kept on
+	// 	the heap so that the editor stays movable)
+	struct Validation;
+
+	std::unique_ptr <Validation> _validation;
+
 	Fields _fields;
 
 	// Quit flag
 	bool _quit = false;
 	bool _escape = false;
 
-	// Check movement input
-	bool _check_movement_input(int c, int &field) {
-		switch (c) {
-		case KEY_UP:
-			if (field > 0)
-				field--;
-			return true;
-		case KEY_DOWN:
-			if (field < _fields.size())
-				field++;
-			return true;
-		case 10: // Enter key
-			if (field == _fields.size())
-				_quit = true;
-			return true;
-		case '\t':
-			// Cycle through fields
-			if (field == _fields.size())
-				field = 0;
-			else
-				field++;
-
-			return true;
-		case 27: // Escape key
-			_escape = true;
-			_quit = true;
-			return true;
-		default:
-			break;
-		}
+	// Current field, and the fields changed since the last frame
+	int _field = 0;
+	std::vector <bool> _dirty;
 
-		return false;
-	}
+	// Keys which are not bound go to the yielders (defaults are
+	// 	bound by the constructor)
+	Keymap _keymap;
 
-	// Print ok button
-	void _print_ok(bool highlight) {
-		if (highlight)
-			attribute_set(A_REVERSE);
+	// Check movement input
+	bool _check_movement_input(int c, int &field);
 
-		mvprintf(info.height - 6, info.width / 2 - 4, "[ OK ]");
+	// Print ok button (refreshed with the rest of the frame)
+	void _print_ok(bool highlight);
 
-		if (highlight)
-			attribute_set(A_NORMAL);
-	}
+	// Columns for a field's content, and the columns taken
+	// 	from them by its validation message
+	int _room(int field) const;
+	int _message_width(int field) const;
 
-	// Update field
-	void _update_field(int field, const std::vector <Yielder> &yielders) {
-		// Substring to print
-		std::string substr = yielders[field]->content();
-
-		// Check if scrolling is needed
-		size_t l = _fields[field].size() + 1
-			+ yielders[field]->content().size();
-
-		if (l + 5 > info.width) {
-			// Scroll by taking substring
-			size_t offset = (l + 4) - info.width;
-			substr = yielders[field]->content().substr(offset);
-		}
+	// Visible part of a field's content, scrolled so that
+	// 	the end is always in view
+	std::string _visible(int field, const std::vector <Yielder> &yielders);
 
-		// First clear the field's line
-		cursor(field, 0);
-		wclrtoeol(_main);
+	// Column of the cursor at the end of a field
+	int _cursor_x(int field, const std::vector <Yielder> &yielders);
 
-		// Reprint the field line
-		mvprintf(field, 0, "%s  %s",
-			_fields[field].c_str(),
-			substr.c_str()
-		);
-	}
+	// Update field
+	void _update_field(int field, const std::vector <Yielder> &yielders);
+
+	// Validation of the fields: queue a changed value, whether any
+	// 	check is still running, take in (and draw) new results, and
+	// 	whether all the fields are valid
+	void _validate(int field, const std::string &value, bool now = false);
+	bool _validating() const;
+	bool _collect(const std::vector <Yielder> &yielders);
+	bool _valid() const;
+
+	// Steps of an interaction, shared by yield and the scheduler:
+	// 	keys are fed one at a time, changed fields are redrawn
+	// 	once per frame
+	void _begin(const std::vector <Yielder> &yielders);
+	void _feed(int c, const std::vector <Yielder> &yielders);
+	void _draw(const std::vector <Yielder> &yielders);
+	void _end();
+
+	friend class Scheduler;
 public:
 	// Default constructor
 	FieldEditor() = default;
@@ -777,97 +1960,428 @@ public:
 	// Constructor
 	// TODO: remove screeninfo parameter (make a separate constructor)
 	FieldEditor(const std::string &title, const Fields &fnames,
-			const ScreenInfo &info)
-			: DecoratedWindow(title, info), _fields(fnames) {
-		// Pad all fields with spaces
-		size_t max_len = 0;
-		for (const auto &f : _fields)
-			max_len = std::max(max_len, f.size());
-
-		for (auto &f : _fields)
-			f.resize(max_len + 2, ' ');
-
-		// Write the fields
-		int line = 0;
-		for (const auto &f : _fields) {
-			mvprintf(line, 0, "%s ", f.c_str());
-			line++;
-		}
+			const ScreenInfo &info);
 
-		// Add [ OK ] button
-		_print_ok(false);
+	// The validation state moves along with the editor
+	FieldEditor(FieldEditor &&);
+	FieldEditor &operator=(FieldEditor &&);
+
+	// Destructor, stops the validation worker
+	~FieldEditor();
+
+	// Bind a key to an action (replacing its previous binding)
+	void bind(int key, Action action);
+
+	// Remove the binding of a key
+	void unbind(int key);
+
+	// Key bindings
+	Keymap &keymap() {
+		return _keymap;
 	}
 
+	// Check a field in the background, once its value has not
+	// 	changed for the debounce period; errors are shown next to
+	// 	the field and keep the form from being confirmed
+	void set_validator(int field, const Validator &validator,
+			std::chrono::milliseconds debounce = std::chrono::milliseconds(250));
+
+	// Same, for validators which run to completion
+	void set_validator(int field, const std::function <std::string (const std::string &)> &validator,
+			std::chrono::milliseconds debounce = std::chrono::milliseconds(250)) {
+		set_validator(field, [validator](const std::string &value, const Cancelled &) {
+			return validator(value);
+		}, debounce);
+	}
+
+	// Error message shown for a field (empty if there is none)
+	std::string message(int field) const;
+
 	// Yield the fields
 	// TODO: print error message if some conditions are not met
 	// (condition functions passed as another object -- input is the list of
 	// yeidlers)
-	bool yield(const std::vector <Yielder> &yielders) {
-		// Field index
-		int field = 0;
-
-		// Set keyboard input
-		keypad(_main, true);
-
-		// Turn off echo
-		noecho();
-
-		// Update all fields
-		for (int i = 0; i < _fields.size(); i++)
-			_update_field(i, yielders);
-
-		// Move cursor
-		cursor(0, _fields[0].size() + 2
-			+ yielders[0]->content().size());
-		curs_set(1);
-
-		// Get the fields
-		int c;
-		while ((c = getc())) {
-			// Check for movement inputs
-			bool moved = _check_movement_input(c, field);
-
-			// Check for quit
-			if (_quit)
-				break;
-
-			// Highlight the ok button if needed
-			if (field >= _fields.size()) {
-				curs_set(0);
-				_print_ok(true);
-				continue;
-			} else {
-				curs_set(1);
-				_print_ok(false);
-			}
+	bool yield(const std::vector <Yielder> &yielders);
+};
 
-			// Cursor position
-			size_t l = _fields[field].size() + 2
-				+ yielders[field]->content().size();
+////////////////
+// Coroutines //
+////////////////
 
-			// Move the cursor
-			cursor(field, _fields[field].size() + 2
-				+ yielders[field]->content().size());
+// Coroutine versions of the interactive windows, so that several of
+// 	them can be live at once on one thread; defined inline since the
+// 	library itself may be built without coroutine support
+#if defined(__cpp_impl_coroutine)
 
-			// Skip if moved
-			if (moved)
-				continue;
+// Promise parts shared by all tasks: tasks start suspended and resume
+// 	whoever awaits them once they finish
+struct TaskPromiseBase {
+	std::coroutine_handle <> continuation;
+	std::exception_ptr exception;
+
+	struct Final {
+		bool await_ready() noexcept {
+			return false;
+		}
+
+		template <class P>
+		std::coroutine_handle <> await_suspend(std::coroutine_handle <P> handle) noexcept {
+			auto next = handle.promise().continuation;
+			return next ? next : std::noop_coroutine();
+		}
 
-			// Yield the field
-			auto ret = yielders[field]->proc(c);
-			if (ret != base_yielder::Ret::RET_NOP) {
-				// Update the field
-				_update_field(field, yielders);
+		void await_resume() noexcept {}
+	};
+
+	std::suspend_always initial_suspend() noexcept {
+		return {};
+	}
+
+	Final final_suspend() noexcept {
+		return {};
+	}
+
+	void unhandled_exception() {
+		exception = std::current_exception();
+	}
+};
+
+template <class T>
+struct TaskPromise : TaskPromiseBase {
+	std::optional <T> value;
+
+	void return_value(T v) {
+		value = std::move(v);
+	}
+
+	T result() {
+		if (exception)
+			std::rethrow_exception(exception);
+
+		return std::move(*value);
+	}
+};
+
+template <>
+struct TaskPromise <void> : TaskPromiseBase {
+	void return_void() {}
+
+	void result() {
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+};
+
+// Coroutine which can await windows (through a scheduler) and other
+// 	tasks, returning a T
+template <class T = void>
+class Task {
+public:
+	struct promise_type : TaskPromise <T> {
+		Task get_return_object() {
+			return Task(std::coroutine_handle <promise_type> ::from_promise(*this));
+		}
+	};
+
+	using Handle = std::coroutine_handle <promise_type>;
+private:
+	Handle _handle;
+
+	explicit Task(Handle handle) : _handle(handle) {}
+public:
+	Task(Task &&other) noexcept
+			: _handle(std::exchange(other._handle, nullptr)) {}
+
+	Task &operator=(Task &&other) noexcept {
+		if (this != &other) {
+			if (_handle)
+				_handle.destroy();
+
+			_handle = std::exchange(other._handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	Task(const Task &) = delete;
+	Task &operator=(const Task &) = delete;
+
+	~Task() {
+		if (_handle)
+			_handle.destroy();
+	}
+
+	// Whether the task has finished
+	bool done() const {
+		return !_handle || _handle.done();
+	}
+
+	// Exception the task finished with, if any
+	std::exception_ptr exception() const {
+		return done() && _handle ? _handle.promise().exception : nullptr;
+	}
+
+	// Run the task until its first suspension
+	void start() {
+		if (!done())
+			_handle.resume();
+	}
+
+	// Awaiting a task runs it, and resumes the awaiter with its
+	// 	result once it finishes
+	auto operator co_await() noexcept {
+		struct Awaiter {
+			Handle handle;
+
+			bool await_ready() {
+				return !handle || handle.done();
+			}
+
+			std::coroutine_handle <> await_suspend(std::coroutine_handle <> awaiter) {
+				handle.promise().continuation = awaiter;
+				return handle;
 			}
+
+			T await_resume() {
+				return handle.promise().result();
+			}
+		};
+
+		return Awaiter {_handle};
+	}
+};
+
+// Runs tasks on one thread, feeding keys to the window in focus; a
+// 	task awaiting a window is resumed once the window finishes
+class Scheduler {
+public:
+	// Window being awaited
+	struct Interaction {
+		Scheduler *scheduler;
+		std::coroutine_handle <> awaiter;
+
+		Interaction(Scheduler *scheduler) : scheduler(scheduler) {}
+
+		virtual ~Interaction() = default;
+
+		// Window the keys are read from
+		virtual PlainWindow &window() = 0;
+
+		// Steps of the interaction, feed returns true once the
+		// 	window is finished
+		virtual void begin() = 0;
+		virtual bool feed(int c) = 0;
+		virtual void draw() = 0;
+		virtual void end() {}
+
+		// Background work of the window (e.g. validation): whether
+		// 	any is still running, and taking in its results
+		virtual bool busy() {
+			return false;
 		}
 
-		// Disable cursor
-		curs_set(0);
+		virtual void collect() {}
+
+		bool await_ready() {
+			return false;
+		}
 
-		return (!_escape);
+		void await_suspend(std::coroutine_handle <> handle) {
+			awaiter = handle;
+			scheduler->_add(this);
+		}
+	};
+
+	// Awaiting the selection of a SelectionWindow
+	struct SelectionAwaiter : Interaction {
+		SelectionWindow &win;
+		SelectionWindow::Selection &selected;
+
+		SelectionAwaiter(Scheduler *scheduler, SelectionWindow &win,
+				SelectionWindow::Selection &selected)
+				: Interaction(scheduler), win(win), selected(selected) {}
+
+		PlainWindow &window() override {
+			return win;
+		}
+
+		void begin() override {
+			win._begin();
+			win._draw(selected);
+		}
+
+		bool feed(int c) override {
+			win._handle_key(c, selected);
+			return win._terminate;
+		}
+
+		void draw() override {
+			curs_set(0);
+			win._draw(selected);
+		}
+
+		bool await_resume() {
+			return selected.size() > 0;
+		}
+	};
+
+	// Awaiting the fields of a FieldEditor
+	struct EditAwaiter : Interaction {
+		FieldEditor &win;
+		std::vector <Yielder> yielders;
+
+		EditAwaiter(Scheduler *scheduler, FieldEditor &win,
+				const std::vector <Yielder> &yielders)
+				: Interaction(scheduler), win(win), yielders(yielders) {}
+
+		PlainWindow &window() override {
+			return win;
+		}
+
+		void begin() override {
+			win._begin(yielders);
+		}
+
+		bool feed(int c) override {
+			win._feed(c, yielders);
+			return win._quit;
+		}
+
+		void draw() override {
+			win._draw(yielders);
+		}
+
+		void end() override {
+			win._end();
+		}
+
+		bool busy() override {
+			return win._validating();
+		}
+
+		void collect() override {
+			if (win._collect(yielders))
+				stage_window(win._main);
+		}
+
+		bool await_resume() {
+			return !win._escape;
+		}
+	};
+private:
+	std::vector <Task <>> _tasks;
+	std::vector <Interaction *> _pending;
+	size_t _focus = 0;
+	int _focus_key = KEY_BTAB;
+
+	void _add(Interaction *interaction) {
+		_pending.push_back(interaction);
+		interaction->begin();
+	}
+
+	// Drop the finished tasks, rethrowing the first exception one
+	// 	of them finished with (awaited tasks rethrow to their
+	// 	awaiters instead)
+	void _reap() {
+		std::exception_ptr exception;
+		_tasks.erase(std::remove_if(_tasks.begin(), _tasks.end(),
+			[&](const Task <> &task) {
+				if (!task.done())
+					return false;
+
+				if (!exception)
+					exception = task.exception();
+
+				return true;
+			}
+		), _tasks.end());
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	// Take a finished interaction out, then resume its task
+	void _finish(size_t index) {
+		Interaction *interaction = _pending[index];
+		_pending.erase(_pending.begin() + index);
+		if (_focus >= _pending.size())
+			_focus = 0;
+
+		interaction->end();
+		interaction->awaiter.resume();
+	}
+public:
+	// Start a task, it runs until it awaits a window (exceptions
+	// 	thrown by tasks are rethrown from spawn or run)
+	void spawn(Task <> task) {
+		_tasks.push_back(std::move(task));
+		_tasks.back().start();
+		_reap();
+	}
+
+	// Await a selection, true if anything was selected
+	SelectionAwaiter select(SelectionWindow &win, SelectionWindow::Selection &selected) {
+		return SelectionAwaiter(this, win, selected);
+	}
+
+	// Await the fields of an editor, false if it was cancelled
+	EditAwaiter edit(FieldEditor &win, const std::vector <Yielder> &yielders) {
+		return EditAwaiter(this, win, yielders);
+	}
+
+	// Key which moves the focus to the next window (shift-tab
+	// 	by default)
+	void set_focus_key(int key) {
+		_focus_key = key;
+	}
+
+	// Number of windows being awaited
+	size_t pending() const {
+		return _pending.size();
+	}
+
+	// Feed keys to the window in focus until no task is waiting
+	// 	for input
+	void run() {
+		while (!_pending.empty()) {
+			// Results of background work, in any window
+			bool polling = false;
+			for (Interaction *interaction : _pending) {
+				interaction->collect();
+				polling |= interaction->busy();
+			}
+
+			Interaction *focus = _pending[_focus];
+			focus->draw();
+
+			// Poll while background work is running
+			int c = polling ? focus->window().try_getc() : focus->window().getc();
+			if (c == ERR && polling) {
+				Screen::sleep(16);
+				continue;
+			}
+
+			// Apply all pending keys before the next frame
+			do {
+				if (c == _focus_key) {
+					_focus = (_focus + 1) % _pending.size();
+					break;
+				}
+
+				if (focus->feed(c)) {
+					_finish(_focus);
+					_reap();
+					break;
+				}
+			} while ((c = focus->window().try_getc()) != ERR);
+		}
+
+		_reap();
 	}
 };
 
+#endif
+
 }
 
 #endif
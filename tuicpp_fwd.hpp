@@ -0,0 +1,60 @@
+#ifndef TUICPP_FWD_H_
+#define TUICPP_FWD_H_
+
+// Forward declarations of the tuicpp types, for headers which only
+// 	pass windows around (include tuicpp.hpp to use them)
+namespace tuicpp {
+
+// Sessions
+class Screen;
+class WindowPool;
+
+// Rendering and input
+class Renderer;
+class Recorder;
+class Replayer;
+class HeadlessScreen;
+
+// Windows
+struct ScreenInfo;
+
+class Window;
+class PlainWindow;
+class BoxedWindow;
+class DecoratedWindow;
+class SelectionWindow;
+class TreeView;
+class Chart;
+class ProgressBoard;
+class FuzzyFinder;
+class FieldEditor;
+
+template <class T>
+class Table;
+
+template <class T>
+class NumericTable;
+
+// Input streams
+class DelimitedReader;
+
+// Field editing
+class Completions;
+struct base_yielder;
+
+template <class T>
+struct Tyielder;
+
+// Coroutines (C++20, the default argument of Task is in tuicpp.hpp)
+#if defined(__cpp_impl_coroutine)
+
+template <class T>
+class Task;
+
+class Scheduler;
+
+#endif
+
+}
+
+#endif
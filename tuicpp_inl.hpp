@@ -0,0 +1,1072 @@
+#ifndef TUICPP_INL_H_
+#define TUICPP_INL_H_
+
+// Member definitions of the table templates, for tables of types
+// 	other than the ones instantiated in tuicpp.cpp
+
+// Standard headers
+#include <thread>
+
+#include "tuicpp.hpp"
+
+namespace tuicpp {
+
+// Table
+template <class T>
+attr_t Table <T> ::_combine(attr_t attr, attr_t add) {
+	if (add & A_COLOR)
+		attr &= ~A_COLOR;
+
+	return attr | add;
+}
+
+template <class T>
+void Table <T> ::_style_row(size_t index) {
+	if (!_styled())
+		return;
+
+	size_t columns = _headers.size();
+	if (_attrs.size() < _data.size() * columns)
+		_attrs.resize(_data.size() * columns, A_NORMAL);
+
+	attr_t *attrs = &_attrs[index * columns];
+	for (size_t i = 0; i < columns; i++)
+		attrs[i] = (i < _style.columns.size()) ? _style.columns[i] : A_NORMAL;
+
+	const T &d = _data[index];
+	for (const Rule &rule : _style.rules) {
+		if (!rule.predicate(d))
+			continue;
+
+		if (rule.column < 0) {
+			for (size_t i = 0; i < columns; i++)
+				attrs[i] = _combine(attrs[i], rule.attr);
+		} else if (rule.column < (int) columns) {
+			attrs[rule.column] = _combine(attrs[rule.column], rule.attr);
+		}
+	}
+}
+
+template <class T>
+void Table <T> ::_restyle() {
+	_attrs.clear();
+	if (!_styled())
+		return;
+
+	_attrs.resize(_data.size() * _headers.size(), A_NORMAL);
+	for (size_t n = 0; n < _data.size(); n++)
+		_style_row(n);
+}
+
+template <class T>
+attr_t Table <T> ::_cell_attr(size_t index, size_t column, size_t n) const {
+	attr_t attr = _attrs.empty() ? A_NORMAL
+		: _attrs[index * _headers.size() + column];
+
+	// Stripes don't cover the colors of the cell
+	if (n % 2) {
+		attr_t stripe = _style.stripe;
+		if (attr & A_COLOR)
+			stripe &= ~A_COLOR;
+
+		attr |= stripe;
+	}
+
+	return attr;
+}
+
+template <class T>
+typename Table <T> ::Key Table <T> ::_make_key(const std::string &str) {
+	Key key {str, 0, false};
+
+	char *end = nullptr;
+	key.num = std::strtod(str.c_str(), &end);
+
+	// NaNs are left as strings to keep the ordering strict
+	key.numeric = !str.empty() && *end == '\0' && key.num == key.num;
+	return key;
+}
+
+template <class T>
+bool Table <T> ::_before(size_t a, size_t b) const {
+	const Key &ka = _keys[a];
+	const Key &kb = _keys[b];
+
+	int cmp = 0;
+	if (ka.numeric && kb.numeric)
+		cmp = (ka.num < kb.num) ? -1 : (kb.num < ka.num);
+	else if (ka.numeric != kb.numeric)
+		cmp = ka.numeric ? -1 : 1;
+	else
+		cmp = ka.str.compare(kb.str);
+
+	if (!_ascending)
+		cmp = -cmp;
+
+	if (cmp != 0)
+		return cmp < 0;
+
+	return a < b;
+}
+
+template <class T>
+void Table <T> ::_get_keys() {
+	_keys.resize(_data.size());
+	for (size_t n = 0; n < _data.size(); n++)
+		_keys[n] = _make_key(_generator(_data[n], _sort_column));
+}
+
+template <class T>
+void Table <T> ::_sort_order() {
+	auto cmp = [this](size_t a, size_t b) {
+		return _before(a, b);
+	};
+
+	auto begin = _order.begin();
+	size_t n = _order.size();
+	size_t threads = std::thread::hardware_concurrency();
+	if (n < parallel_threshold || threads < 2) {
+		std::sort(begin, _order.end(), cmp);
+		return;
+	}
+
+	// Sort chunks in parallel...
+	size_t chunk = (n + threads - 1) / threads;
+
+	std::vector <size_t> bounds;
+	for (size_t i = 0; i < n; i += chunk)
+		bounds.push_back(i);
+	bounds.push_back(n);
+
+	std::vector <std::thread> pool;
+	for (size_t k = 0; k + 1 < bounds.size(); k++) {
+		pool.emplace_back([&, k]() {
+			std::sort(begin + bounds[k], begin + bounds[k + 1], cmp);
+		});
+	}
+
+	for (auto &thread : pool)
+		thread.join();
+
+	// ...then merge neighbouring chunks in parallel
+	while (bounds.size() > 2) {
+		std::vector <size_t> next;
+
+		pool.clear();
+		size_t k = 0;
+		for (; k + 2 < bounds.size(); k += 2) {
+			pool.emplace_back([&, k]() {
+				std::inplace_merge(begin + bounds[k],
+					begin + bounds[k + 1],
+					begin + bounds[k + 2], cmp);
+			});
+
+			next.push_back(bounds[k]);
+		}
+
+		// Odd chunk out is carried over
+		if (k + 1 < bounds.size())
+			next.push_back(bounds[k]);
+		next.push_back(n);
+
+		for (auto &thread : pool)
+			thread.join();
+
+		bounds = next;
+	}
+}
+
+template <class T>
+void Table <T> ::_reorder() {
+	_order.resize(_data.size());
+	for (size_t n = 0; n < _order.size(); n++)
+		_order[n] = n;
+
+	if (_sort_column < 0)
+		return;
+
+	_get_keys();
+	_sort_order();
+}
+
+template <class T>
+std::vector <size_t> ::iterator Table <T> ::_find(size_t index) {
+	return std::lower_bound(_order.begin(), _order.end(), index,
+		[this](size_t a, size_t b) {
+			return _before(a, b);
+		}
+	);
+}
+
+template <class T>
+void Table <T> ::_fit_row(size_t index) {
+	if (!_auto_lengths)
+		return;
+
+	for (size_t i = 0; i < _headers.size(); i++) {
+		size_t l = display_width(_generator(_data[index], i));
+		if (l > _lengths[i])
+			_lengths[i] = l;
+	}
+}
+
+template <class T>
+std::string Table <T> ::_row_text(size_t index) const {
+	std::string text;
+	for (size_t i = 0; i < _headers.size(); i++) {
+		text += _generator(_data[index], i);
+		text += '\n';
+	}
+
+	return text;
+}
+
+template <class T>
+bool Table <T> ::_match(size_t index) {
+	if (_predicate && !_predicate(_data[index]))
+		return false;
+
+	if (_query.empty())
+		return true;
+
+	if (_text.size() != _data.size()) {
+		_text.resize(_data.size());
+		for (size_t n = 0; n < _data.size(); n++)
+			_text[n] = _row_text(n);
+	}
+
+	return _text[index].find(_query) != std::string::npos;
+}
+
+template <class T>
+void Table <T> ::_rescan(bool narrower) {
+	if (!_filtered()) {
+		_shown.assign(_data.size(), 1);
+		_matches.clear();
+		_visible.clear();
+		return;
+	}
+
+	if (narrower) {
+		auto end = std::remove_if(_matches.begin(), _matches.end(),
+			[this](size_t index) {
+				if (_match(index))
+					return false;
+
+				_shown[index] = 0;
+				return true;
+			}
+		);
+
+		_matches.erase(end, _matches.end());
+
+		_visible.erase(std::remove_if(_visible.begin(), _visible.end(),
+			[this](size_t index) {
+				return !_shown[index];
+			}
+		), _visible.end());
+		return;
+	}
+
+	_shown.assign(_data.size(), 0);
+	_matches.clear();
+	for (size_t n = 0; n < _data.size(); n++) {
+		if (_match(n)) {
+			_shown[n] = 1;
+			_matches.push_back(n);
+		}
+	}
+
+	_index_visible();
+}
+
+template <class T>
+void Table <T> ::_rescan_row(size_t index) {
+	if (_shown.size() < _data.size())
+		_shown.resize(_data.size(), 0);
+
+	if (!_text.empty())
+		_text.resize(_data.size());
+	if (index < _text.size())
+		_text[index] = _row_text(index);
+
+	if (!_filtered()) {
+		_shown[index] = 1;
+		return;
+	}
+
+	bool match = _match(index);
+
+	// Place the row in the display order, unless it is there (it is
+	// 	taken out beforehand when its sort key changes)
+	auto at = _find_visible(index);
+	bool placed = at != _visible.end() && *at == index;
+	if (match && !placed)
+		_visible.insert(at, index);
+	else if (!match && placed)
+		_visible.erase(at);
+
+	if (match == (bool) _shown[index])
+		return;
+
+	_shown[index] = match;
+
+	auto it = std::lower_bound(_matches.begin(), _matches.end(), index);
+	if (match)
+		_matches.insert(it, index);
+	else
+		_matches.erase(it);
+}
+
+template <class T>
+void Table <T> ::_index_visible() {
+	_visible.clear();
+	if (!_filtered())
+		return;
+
+	_visible.reserve(_matches.size());
+	for (size_t index : _order) {
+		if (_shown[index])
+			_visible.push_back(index);
+	}
+}
+
+template <class T>
+std::vector <size_t> ::iterator Table <T> ::_find_visible(size_t index) {
+	if (_sort_column < 0)
+		return std::lower_bound(_visible.begin(), _visible.end(), index);
+
+	return std::lower_bound(_visible.begin(), _visible.end(), index,
+		[this](size_t a, size_t b) {
+			return _before(a, b);
+		}
+	);
+}
+
+template <class T>
+void Table <T> ::_reset_filter() {
+	_text.clear();
+	_rescan();
+}
+
+template <class T>
+void Table <T> ::_push(const T &value) {
+	size_t index = _data.size();
+	_data.push_back(value);
+
+	if (_sort_column >= 0) {
+		_keys.push_back(_make_key(_generator(value, _sort_column)));
+		_order.insert(_find(index), index);
+	} else {
+		_order.push_back(index);
+	}
+
+	_rescan_row(index);
+	_fit_row(index);
+	_style_row(index);
+}
+
+template <class T>
+void Table <T> ::_redraw() {
+	erase();
+	_write_table();
+	refresh_window(_main);
+}
+
+template <class T>
+void Table <T> ::_get_lengths() {
+	_lengths = Lengths(_headers.size(), 0);
+
+	for (size_t i = 0; i < _headers.size(); i++) {
+		_lengths[i] = display_width(_headers[i]);
+		for (const auto &d : _data) {
+			size_t l = display_width(_generator(d, i));
+			if (l > _lengths[i])
+				_lengths[i] = l;
+		}
+	}
+}
+
+template <class T>
+std::vector <std::pair <size_t, size_t>> Table <T> ::_view_columns(int width) const {
+	std::vector <std::pair <size_t, size_t>> columns;
+
+	size_t frozen = std::min(_frozen, _headers.size());
+
+	int x = 1;
+	auto fit = [&](size_t i) {
+		int span = _lengths[i] + 3;
+		if (x + span <= width) {
+			columns.push_back({i, _lengths[i]});
+			x += span;
+			return true;
+		}
+
+		if (width - x > 3)
+			columns.push_back({i, width - x - 3});
+
+		return false;
+	};
+
+	for (size_t i = 0; i < frozen; i++) {
+		if (!fit(i))
+			return columns;
+	}
+
+	for (size_t i = frozen + _column_offset; i < _headers.size(); i++) {
+		if (!fit(i))
+			break;
+	}
+
+	return columns;
+}
+
+template <class T>
+size_t Table <T> ::_view_rows() const {
+	int height = getmaxy(_main);
+	return std::max(height - 4, 0);
+}
+
+template <class T>
+void Table <T> ::_write_bar(int line, const std::vector <std::pair <size_t, size_t>> &columns,
+		chtype left, chtype middle, chtype right) const {
+	int x = 0;
+
+	mvwaddch(_main, line, 0, left);
+	for (size_t k = 0; k < columns.size(); k++) {
+		for (size_t j = 0; j < columns[k].second + 2; j++)
+			mvwaddch(_main, line, x + j + 1, ACS_HLINE);
+		x += columns[k].second + 3;
+
+		mvwaddch(_main, line, x, (k + 1 < columns.size()) ? middle : right);
+	}
+}
+
+template <class T>
+void Table <T> ::_write_table() const {
+	int width = getmaxx(_main);
+
+	auto columns = _view_columns(width);
+	if (columns.empty())
+		return;
+
+	// Top bar, with arrows if columns are scrolled out of view
+	_write_bar(0, columns, ACS_ULCORNER, ACS_TTEE, ACS_URCORNER);
+
+	size_t frozen = std::min(_frozen, columns.size());
+	if (_column_offset > 0) {
+		int x = 2;
+		for (size_t k = 0; k < frozen; k++)
+			x += columns[k].second + 3;
+
+		mvwaddch(_main, 0, x, ACS_LARROW);
+	}
+
+	const auto &last = columns.back();
+	if (last.first + 1 < _headers.size() || last.second < _lengths[last.first]) {
+		int x = 0;
+		for (const auto &column : columns)
+			x += column.second + 3;
+
+		mvwaddch(_main, 0, x - 1, ACS_RARROW);
+	}
+
+	// Headers
+	int x = 1;
+	for (const auto &column : columns) {
+		size_t i = column.first;
+		wattrset(_main, _style.header);
+		mvwprintw(_main, 1, x, " %s ",
+			pad_width(_headers[i], column.second).c_str());
+		wattrset(_main, A_NORMAL);
+		x += column.second + 3;
+		mvwaddch(_main, 1, x - 1, ACS_VLINE);
+
+		// Sort direction indicator
+		if ((int) i == _sort_column)
+			mvwaddch(_main, 1, x - 2, _ascending ? ACS_UARROW : ACS_DARROW);
+	}
+	mvwaddch(_main, 1, 0, ACS_VLINE);
+
+	_write_bar(2, columns, ACS_LTEE, ACS_PLUS, ACS_RTEE);
+
+	// Body, from the first row in view
+	size_t rows = _view_rows();
+	size_t shown = visible();
+	size_t offset = std::min(_row_offset, shown > rows ? shown - rows : 0);
+
+	int line = 3;
+	for (size_t n = offset; n < shown && n < offset + rows; n++) {
+		size_t index = _shown_row(n);
+
+		const T &d = _data[index];
+		bool highlight = (long) n == _highlight;
+
+		x = 1;
+		for (const auto &column : columns) {
+			// Pad string with spaces
+			std::string str = pad_width(_generator(d, column.first), column.second);
+
+			// Styled, the highlight goes on top
+			attr_t attr = _cell_attr(index, column.first, n);
+			if (highlight)
+				attr = _combine(attr, A_REVERSE);
+
+			wattrset(_main, attr);
+			mvwprintw(_main, line, x, " %s ", str.c_str());
+			wattrset(_main, A_NORMAL);
+
+			x += column.second + 3;
+			mvwaddch(_main, line, x - 1, ACS_VLINE);
+		}
+		mvwaddch(_main, line, 0, ACS_VLINE);
+		line++;
+	}
+
+	_write_bar(line, columns, ACS_LLCORNER, ACS_BTEE, ACS_LRCORNER);
+}
+
+template <class T>
+Table <T> ::Table(const From &from, int height, int width, int y, int x)
+		: PlainWindow(height, width, y, x),
+		_headers(from.headers), _data(from.data),
+		_generator(from.generator), _lengths(from.lengths) {
+	// Get lengths (auto)
+	_auto_lengths = _lengths.empty();
+	if (_auto_lengths)
+		_get_lengths();
+
+	// Rows start in data order, unfiltered
+	_reorder();
+	_reset_filter();
+	_restyle();
+
+	// Resize window if requested
+	if (from.auto_resize) {
+		int new_height = _data.size() + 4;
+		int new_width = 1;
+		for (const auto &l : _lengths)
+			new_width += l + 3;
+		resize(new_height, new_width);
+	}
+
+	// Write table, painted along with the first frame
+	_write_table();
+	stage_window(_main);
+}
+
+template <class T>
+void Table <T> ::set_data(const Data &data, bool auto_resize) {
+	// First, erase
+	erase();
+
+	_data = data;
+	_reorder();
+	_reset_filter();
+	_restyle();
+
+	if (auto_resize) {
+		_lengths.clear();
+		_get_lengths();
+		_auto_lengths = true;
+		resize(_data.size() + 4, 1);
+	}
+
+	_write_table();
+	refresh_window(_main);
+}
+
+template <class T>
+void Table <T> ::set_lengths(const Lengths &lengths) {
+	// First, erase
+	erase();
+
+	_lengths = lengths;
+	_auto_lengths = false;
+	_write_table();
+	refresh_window(_main);
+}
+
+template <class T>
+void Table <T> ::set_generator(const Generator &generator) {
+	// First, erase
+	erase();
+
+	_generator = generator;
+	_reorder();
+	_reset_filter();
+	_write_table();
+	refresh_window(_main);
+}
+
+template <class T>
+void Table <T> ::set_style(const Style &style) {
+	_style = style;
+	_restyle();
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::highlight_row(int row) {
+	_highlight = row;
+
+	size_t rows = _view_rows();
+	if (row >= 0 && rows > 0) {
+		if ((size_t) row < _row_offset)
+			_row_offset = row;
+		else if ((size_t) row >= _row_offset + rows)
+			_row_offset = row - rows + 1;
+	}
+
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::freeze_columns(size_t columns) {
+	_frozen = columns;
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::scroll_columns(int delta) {
+	long max = (long) _headers.size() - (long) _frozen - 1;
+	// Clamped, so never negative
+	long offset = std::clamp((long) _column_offset + delta, 0l, std::max(max, 0l));
+	if ((size_t) offset == _column_offset)
+		return;
+
+	_column_offset = offset;
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::scroll_rows(int delta) {
+	long rows = _view_rows();
+	long max = std::max((long) visible() - rows, 0l);
+	long offset = std::clamp((long) _row_offset + delta, 0l, max);
+	if ((size_t) offset == _row_offset)
+		return;
+
+	_row_offset = offset;
+	_redraw();
+}
+
+template <class T>
+bool Table <T> ::scroll_key(int c) {
+	int page = std::max((int) _view_rows() - 1, 1);
+
+	switch (c) {
+	case KEY_LEFT:
+		scroll_columns(-1);
+		return true;
+	case KEY_RIGHT:
+		scroll_columns(1);
+		return true;
+	case KEY_UP:
+		scroll_rows(-1);
+		return true;
+	case KEY_DOWN:
+		scroll_rows(1);
+		return true;
+	case KEY_PPAGE:
+		scroll_rows(-page);
+		return true;
+	case KEY_NPAGE:
+		scroll_rows(page);
+		return true;
+	}
+
+	return false;
+}
+
+template <class T>
+void Table <T> ::sort_by(size_t column, bool ascending) {
+	if (column >= _headers.size())
+		return;
+
+	// Keys are only extracted when the column changes
+	bool extract = (_sort_column != (int) column)
+		|| (_keys.size() != _data.size());
+
+	_sort_column = column;
+	_ascending = ascending;
+
+	if (extract)
+		_get_keys();
+
+	_sort_order();
+	_index_visible();
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::unsort() {
+	_sort_column = -1;
+	_keys.clear();
+	_reorder();
+	_index_visible();
+	_redraw();
+}
+
+template <class T>
+bool Table <T> ::sort_key(int c) {
+	if (c == '0') {
+		unsort();
+		return true;
+	}
+
+	if (c < '1' || c > '9')
+		return false;
+
+	int column = c - '1';
+	if (column >= (int) _headers.size())
+		return false;
+
+	if (column == _sort_column)
+		sort_by(column, !_ascending);
+	else
+		sort_by(column, true);
+
+	return true;
+}
+
+template <class T>
+void Table <T> ::set_row(size_t index, const T &value) {
+	if (index >= _data.size())
+		return;
+
+	if (_sort_column >= 0) {
+		// Take the row out with its old key...
+		_order.erase(_find(index));
+		if (_filtered() && _shown[index])
+			_visible.erase(_find_visible(index));
+
+		// ...and put it back with the new one
+		_data[index] = value;
+		_keys[index] = _make_key(_generator(value, _sort_column));
+		_order.insert(_find(index), index);
+	} else {
+		_data[index] = value;
+	}
+
+	_rescan_row(index);
+	_fit_row(index);
+	_style_row(index);
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::append(const T &value) {
+	_push(value);
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::append_rows(const Data &rows) {
+	for (const T &value : rows)
+		_push(value);
+
+	_redraw();
+}
+
+template <class T>
+bool Table <T> ::ingest(DelimitedReader &reader, const Parser &parse,
+		std::chrono::milliseconds period) {
+	std::vector <DelimitedReader::Record> records;
+	bool open = reader.read(records);
+
+	if (!records.empty()) {
+		size_t rows = _view_rows();
+		bool follow = _row_offset + rows >= visible();
+
+		for (const auto &record : records)
+			_push(parse(record));
+
+		if (follow)
+			_row_offset = (visible() > rows) ? visible() - rows : 0;
+
+		_stale = true;
+	}
+
+	// Rows left over are painted by a later call
+	auto now = std::chrono::steady_clock::now();
+	if (_stale && (!open || now - _painted >= period)) {
+		_stale = false;
+		_painted = now;
+		_redraw();
+		present_frame();
+	}
+
+	return open;
+}
+
+template <class T>
+void Table <T> ::ingest_all(DelimitedReader &reader, const Parser &parse,
+		std::chrono::milliseconds period) {
+	while (ingest(reader, parse, period)) {
+		Screen::Unlock unlock;
+		reader.wait(_stale ? period.count() : -1);
+	}
+}
+
+template <class T>
+void Table <T> ::filter(const Predicate &predicate) {
+	_predicate = predicate;
+	_rescan();
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::search(const std::string &query) {
+	bool narrower = !_query.empty()
+		&& query.find(_query) != std::string::npos;
+
+	_query = query;
+	_rescan(narrower);
+	_redraw();
+}
+
+template <class T>
+void Table <T> ::clear_filter() {
+	_predicate = nullptr;
+	_query.clear();
+	_rescan();
+	_redraw();
+}
+
+template <class T>
+long Table <T> ::data_index(size_t row) const {
+	if (row >= visible())
+		return -1;
+
+	return _shown_row(row);
+}
+
+// NumericTable
+template <class T>
+typename NumericTable <T> ::Range NumericTable <T> ::_reduce(const T *data, size_t n) {
+	constexpr size_t lanes = 8;
+
+	Range r {data[0], data[0]};
+
+	T lo[lanes], hi[lanes];
+	for (size_t k = 0; k < lanes; k++)
+		lo[k] = hi[k] = data[0];
+
+	size_t i = 0;
+	for (; i + lanes <= n; i += lanes) {
+		for (size_t k = 0; k < lanes; k++) {
+			T v = data[i + k];
+			lo[k] = v < lo[k] ? v : lo[k];
+			hi[k] = v > hi[k] ? v : hi[k];
+		}
+	}
+
+	for (size_t k = 0; k < lanes; k++) {
+		r.lo = std::min(r.lo, lo[k]);
+		r.hi = std::max(r.hi, hi[k]);
+	}
+
+	for (; i < n; i++) {
+		r.lo = std::min(r.lo, data[i]);
+		r.hi = std::max(r.hi, data[i]);
+	}
+
+	return r;
+}
+
+template <class T>
+int NumericTable <T> ::_format(T v, int precision, int width) const {
+	int n = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		if constexpr (std::is_integral <T> ::value) {
+			n = std::snprintf(_cell.data(), _cell.size(),
+				"%*lld", width, (long long) v);
+		} else {
+			n = std::snprintf(_cell.data(), _cell.size(),
+				"%*.*f", width, precision, (double) v);
+		}
+
+		if (n < (int) _cell.size())
+			break;
+
+		_cell.resize(n + 1);
+	}
+
+	return n;
+}
+
+template <class T>
+void NumericTable <T> ::_measure(size_t i) {
+	const Column &col = _columns[i];
+
+	size_t length = display_width(col.header);
+	if (!col.data.empty()) {
+		_ranges[i] = _reduce(col.data.data(), col.data.size());
+		length = std::max(length, (size_t) _format(_ranges[i].lo, col.precision));
+		length = std::max(length, (size_t) _format(_ranges[i].hi, col.precision));
+	}
+
+	_lengths[i] = length;
+}
+
+template <class T>
+void NumericTable <T> ::_measure() {
+	_ranges.resize(_columns.size());
+	_lengths.resize(_columns.size());
+
+	_rows = 0;
+	for (size_t i = 0; i < _columns.size(); i++) {
+		_measure(i);
+		_rows = std::max(_rows, _columns[i].data.size());
+	}
+
+	_offset = std::min(_offset, _max_offset());
+}
+
+template <class T>
+void NumericTable <T> ::_write_bar(int line, chtype left, chtype middle, chtype right) const {
+	mvwaddch(_main, line, 0, left);
+	for (size_t i = 0; i < _lengths.size(); i++) {
+		for (size_t j = 0; j < _lengths[i] + 2; j++)
+			waddch(_main, ACS_HLINE);
+
+		waddch(_main, (i + 1 < _lengths.size()) ? middle : right);
+	}
+}
+
+template <class T>
+void NumericTable <T> ::_write_table() const {
+	int line = 0;
+
+	werase(_main);
+	_write_bar(line++, ACS_ULCORNER, ACS_TTEE, ACS_URCORNER);
+
+	// Headers
+	wmove(_main, line, 0);
+	waddch(_main, ACS_VLINE);
+	for (size_t i = 0; i < _columns.size(); i++) {
+		wprintw(_main, " %s ",
+			pad_width(_columns[i].header, _lengths[i]).c_str());
+		waddch(_main, ACS_VLINE);
+	}
+	line++;
+
+	_write_bar(line++, ACS_LTEE, ACS_PLUS, ACS_RTEE);
+
+	// Only the rows in view are formatted
+	size_t end = std::min(_rows, _offset + _page());
+	for (size_t n = _offset; n < end; n++) {
+		bool highlight = ((long) n == _highlight);
+
+		wmove(_main, line, 0);
+		waddch(_main, ACS_VLINE);
+		for (size_t i = 0; i < _columns.size(); i++) {
+			const Column &col = _columns[i];
+
+			if (highlight)
+				wattrset(_main, A_REVERSE);
+
+			waddch(_main, ' ');
+			if (n < col.data.size()) {
+				int len = _format(col.data[n], col.precision, _lengths[i]);
+				waddnstr(_main, _cell.data(), len);
+			} else {
+				for (size_t j = 0; j < _lengths[i]; j++)
+					waddch(_main, ' ');
+			}
+			waddch(_main, ' ');
+
+			if (highlight)
+				wattrset(_main, A_NORMAL);
+
+			waddch(_main, ACS_VLINE);
+		}
+		line++;
+	}
+
+	_write_bar(line, ACS_LLCORNER, ACS_BTEE, ACS_LRCORNER);
+}
+
+template <class T>
+void NumericTable <T> ::_redraw() const {
+	_write_table();
+	refresh_window(_main);
+}
+
+template <class T>
+NumericTable <T> ::NumericTable(const Columns &columns, const ScreenInfo &info)
+		: PlainWindow(info), _columns(columns), _cell(64) {
+	// Painted along with the first frame
+	_measure();
+	_write_table();
+	stage_window(_main);
+}
+
+template <class T>
+void NumericTable <T> ::set_columns(const Columns &columns) {
+	_columns = columns;
+	_measure();
+	_redraw();
+}
+
+template <class T>
+void NumericTable <T> ::set_column(size_t i, const std::vector <T> &data) {
+	if (i >= _columns.size())
+		return;
+
+	_columns[i].data = data;
+	_measure();
+	_redraw();
+}
+
+template <class T>
+void NumericTable <T> ::append(const std::vector <T> &row) {
+	for (size_t i = 0; i < _columns.size() && i < row.size(); i++) {
+		Column &col = _columns[i];
+		T v = row[i];
+
+		if (col.data.empty()) {
+			_ranges[i] = Range {v, v};
+		} else {
+			_ranges[i].lo = std::min(_ranges[i].lo, v);
+			_ranges[i].hi = std::max(_ranges[i].hi, v);
+		}
+
+		col.data.push_back(v);
+
+		size_t length = _format(v, col.precision);
+		_lengths[i] = std::max(_lengths[i], length);
+		_rows = std::max(_rows, col.data.size());
+	}
+
+	_redraw();
+}
+
+template <class T>
+void NumericTable <T> ::scroll_rows(long lines) {
+	long offset = (long) _offset + lines;
+	offset = std::max(0l, std::min(offset, (long) _max_offset()));
+	_offset = offset;
+	_redraw();
+}
+
+template <class T>
+void NumericTable <T> ::highlight_row(long row) {
+	_highlight = row;
+	_redraw();
+}
+
+// Instantiated in tuicpp.cpp (the header leaves these to the
+// 	linker, as it has no member definitions to instantiate)
+extern template class Table <int>;
+extern template class Table <float>;
+extern template class Table <double>;
+extern template class Table <std::string>;
+
+extern template class NumericTable <float>;
+extern template class NumericTable <double>;
+
+}
+
+#endif